@@ -0,0 +1,50 @@
+#include "bench_util.hpp"
+#include "instrument.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// an instrumented build counts the allocations already, otherwise they are counted here
+#ifndef ENABLE_INSTRUMENTATION
+static std::atomic<unsigned long long> allocation_count{0};
+
+static void* counted_allocation(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size) {
+    void* ret = counted_allocation(size);
+    if(!ret)
+        throw std::bad_alloc();
+    return ret;
+}
+
+void* operator new[](std::size_t size) {
+    void* ret = counted_allocation(size);
+    if(!ret)
+        throw std::bad_alloc();
+    return ret;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+namespace Bench {
+
+unsigned long long allocations() {
+#ifdef ENABLE_INSTRUMENTATION
+    namespace In = ErrorDynamics::Util::Instrument;
+    return In::thread_stats().counter[(int)In::Counter::ALLOCATIONS];
+#else
+    return allocation_count.load(std::memory_order_relaxed);
+#endif
+}
+
+}
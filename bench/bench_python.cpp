@@ -0,0 +1,110 @@
+#include "bench_util.hpp"
+#include "decoder.hpp"
+#include "utility.hpp"
+
+#include <benchmark/benchmark.h>
+#include <pybind11/embed.h>
+
+namespace Err = ErrorDynamics;
+namespace py = pybind11;
+
+// the stages which need an interpreter: the numpy export of the ML decoders and the deep_decoder_util kernels
+
+const int batch_size = 64;
+
+using IntArray = py::array_t<int, py::array::forcecast | py::array::c_style>;
+
+static void batch_arguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgsProduct({Bench::sizes, Bench::rates})->ArgNames({"d", "p_1e-3"});
+}
+
+static std::vector<Err::PlanarData> make_batch(const benchmark::State& state, int rounds) {
+    auto pool = Bench::make_data_pool(state.range(0), state.range(1) * 1e-3, rounds);
+    return std::vector<Err::PlanarData>(pool.begin(), pool.begin() + batch_size);
+}
+
+static void BM_ToPyarray(benchmark::State& state) {
+    auto batch = make_batch(state, 1);
+    for(auto _: state)
+        benchmark::DoNotOptimize(Decoder::ML::MLDecoder::to_pyarray(batch));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_ToPyarray)->Apply(batch_arguments);
+
+static void BM_ToPyarrayFormat(benchmark::State& state) {
+    auto batch = make_batch(state, 1);
+    auto format = (Decoder::ML::ArrayFormat)state.range(2);
+    for(auto _: state)
+        benchmark::DoNotOptimize(Decoder::ML::MLDecoder::to_pyarray(batch, format));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_ToPyarrayFormat)->ArgsProduct({Bench::sizes, Bench::rates, {1, 2}})->ArgNames({"d", "p_1e-3", "format"});
+
+static void BM_GeneratePyarray(benchmark::State& state) {
+    auto code = std::make_shared<Err::PlanarSurfaceCode>(state.range(0), Bench::make_error_model(state.range(1) * 1e-3, false));
+    for(auto _: state)
+        benchmark::DoNotOptimize(Decoder::ML::MLDecoder::generate_pyarray(code, batch_size, 1, Decoder::ML::ArrayFormat::UINT8));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_GeneratePyarray)->Apply(batch_arguments);
+
+static void BM_GetLogicalError(benchmark::State& state) {
+    IntArray errors = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1)).second;
+    for(auto _: state)
+        benchmark::DoNotOptimize(get_logical_error(errors));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_GetLogicalError)->Apply(batch_arguments);
+
+static void BM_ApplyLogicalError(benchmark::State& state) {
+    IntArray errors = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1)).second;
+    IntArray logical_errors = get_logical_error(errors);
+    for(auto _: state)
+        benchmark::DoNotOptimize(apply_logical_error(errors, logical_errors));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_ApplyLogicalError)->Apply(batch_arguments);
+
+static void BM_IsValid(benchmark::State& state) {
+    IntArray errors = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1)).second;
+    for(auto _: state)
+        benchmark::DoNotOptimize(is_valid(errors));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_IsValid)->Apply(batch_arguments);
+
+static void BM_IsValidUint8(benchmark::State& state) {
+    ErrorArray<uint8_t> errors = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1), Decoder::ML::ArrayFormat::UINT8).second;
+    for(auto _: state)
+        benchmark::DoNotOptimize(is_valid(errors));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_IsValidUint8)->Apply(batch_arguments);
+
+static void BM_QubitType(benchmark::State& state) {
+    int d = state.range(0);
+    for(auto _: state)
+        benchmark::DoNotOptimize(qubit_type(d, d));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_QubitType)->ArgsProduct({Bench::sizes})->ArgNames({"d"});
+
+static void BM_ApplyPhysicalCorrection(benchmark::State& state) {
+    IntArray errors = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1)).second;
+    IntArray corrections = Decoder::ML::MLDecoder::to_pyarray(make_batch(state, 1)).second;
+    for(auto _: state)
+        benchmark::DoNotOptimize(apply_physical_correction(errors, corrections));
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_ApplyPhysicalCorrection)->Apply(batch_arguments);
+
+int main(int argc, char** argv) {
+    py::scoped_interpreter guard{};
+    py::module::import("numpy");
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
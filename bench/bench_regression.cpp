@@ -0,0 +1,347 @@
+#include "bench_util.hpp"
+#include "decoder.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+A throughput regression check. A fixed set of workloads, simulation, graph
+construction and decoding at a few (d, p), runs on the fixed shots of
+bench_util.hpp and is compared against a baseline measured on the same machine:
+
+    bench_regression --baseline baseline.json --update
+    bench_regression --baseline baseline.json [--report out.json] [--min_time 0.5]
+
+A workload regresses when its shots per second drop by more than the speed
+tolerance or its allocations per shot grow by more than the allocation
+tolerance. Both are read from the baseline and can be overridden with
+--speed_tolerance and --allocation_tolerance. The exit status is 1 on a
+regression, so the check can gate a build.
+*/
+
+namespace Err = ErrorDynamics;
+namespace Mt = Decoder::Matching;
+
+namespace {
+
+struct Workload {
+    std::string name;
+    // one shot, the argument numbers the shots
+    std::function<void(int)> run;
+};
+
+struct Measurement {
+    double shots_per_second, allocations_per_shot;
+};
+
+struct Baseline {
+    double speed_tolerance, allocation_tolerance;
+    std::map<std::string, Measurement> workloads;
+    inline Baseline() : speed_tolerance(0.25), allocation_tolerance(0.05) {}
+};
+
+// the (d, p) of every stage, small enough to finish in seconds
+const std::vector<std::pair<int, double>> regression_points = {{7, 0.01}, {7, 0.03}, {15, 0.01}};
+
+std::string workload_name(std::string stage, int d, double p) {
+    std::ostringstream stream;
+    stream << stage << "/d=" << d << "/p=" << p;
+    return stream.str();
+}
+
+std::vector<Workload> make_workloads() {
+    auto ret = std::vector<Workload>();
+    for(auto& point: regression_points) {
+        int d = point.first;
+        double p = point.second;
+        auto shape = Err::CodeScheme::PlanarShape(d, d);
+        auto code = std::make_shared<Err::PlanarSurfaceCode>(d, Bench::make_error_model(p, false));
+        auto pool = std::make_shared<std::vector<Err::PlanarData>>(Bench::make_data_pool(d, p, 1));
+        auto decoder = std::make_shared<Mt::StandardMWPMDecoder>(p, false, shape);
+        ret.push_back({workload_name("simulate", d, p), [code](int) {
+            code->step();
+            auto data = code->get_data();
+            code->reset();
+        }});
+        ret.push_back({workload_name("graph", d, p), [pool, decoder, shape](int n) {
+            auto graph = Bench::make_graph(*decoder, (*pool)[n % Bench::pool_size], shape);
+        }});
+        ret.push_back({workload_name("decode", d, p), [pool, decoder](int n) {
+            auto correction = (*decoder)((*pool)[n % Bench::pool_size]);
+        }});
+    }
+    return ret;
+}
+
+Measurement measure(const Workload& workload, double min_time) {
+    auto ret = Measurement();
+    // one pass over the pool, after one to warm up: the allocations are the same on every run
+    for(int n = 0; n < Bench::pool_size; n++)
+        workload.run(n);
+    auto before = Bench::allocations();
+    for(int n = 0; n < Bench::pool_size; n++)
+        workload.run(n);
+    ret.allocations_per_shot = (double)(Bench::allocations() - before) / Bench::pool_size;
+
+    // the best of a few repetitions, the others were disturbed by something else
+    const int repetitions = 5;
+    ret.shots_per_second = 0;
+    for(int r = 0; r < repetitions; r++) {
+        auto begin = std::chrono::steady_clock::now();
+        long long shots = 0;
+        double elapsed = 0;
+        while(elapsed < min_time) {
+            for(int _ = 0; _ < 16; _++)
+                workload.run(shots++);
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+        ret.shots_per_second = std::max(ret.shots_per_second, shots / elapsed);
+    }
+    return ret;
+}
+
+// the subset of JSON the baseline is written in: objects, arrays, strings and numbers
+class JsonReader {
+    std::string text;
+    size_t position;
+
+    void skip() {
+        while(position < text.size() && std::isspace((unsigned char)text[position]))
+            position++;
+    }
+    void expect(char c) {
+        skip();
+        if(position >= text.size() || text[position] != c)
+            throw std::runtime_error(std::string("baseline: expected '") + c + "' at offset " + std::to_string(position));
+        position++;
+    }
+    bool next_is(char c) {
+        skip();
+        return position < text.size() && text[position] == c;
+    }
+
+    public:
+    JsonReader(std::string _text) : text(_text), position(0) {}
+
+    std::string read_string() {
+        expect('"');
+        auto end = text.find('"', position);
+        if(end == std::string::npos)
+            throw std::runtime_error("baseline: unterminated string");
+        auto ret = text.substr(position, end - position);
+        position = end + 1;
+        return ret;
+    }
+    double read_number() {
+        skip();
+        size_t length = 0;
+        double ret = std::stod(text.substr(position), &length);
+        position += length;
+        return ret;
+    }
+    // calls on_key for every key, which must read the value
+    void read_object(const std::function<void(std::string)>& on_key) {
+        expect('{');
+        if(next_is('}')) {
+            position++;
+            return;
+        }
+        while(true) {
+            auto key = read_string();
+            expect(':');
+            on_key(key);
+            if(!next_is(','))
+                break;
+            position++;
+        }
+        expect('}');
+    }
+    void read_array(const std::function<void()>& on_item) {
+        expect('[');
+        if(next_is(']')) {
+            position++;
+            return;
+        }
+        while(true) {
+            on_item();
+            if(!next_is(','))
+                break;
+            position++;
+        }
+        expect(']');
+    }
+};
+
+Baseline read_baseline(std::string path) {
+    std::ifstream file(path);
+    if(!file.is_open())
+        throw std::runtime_error(std::string("Cannot open the baseline: ") + path + ", measure one with --update");
+    std::stringstream content;
+    content << file.rdbuf();
+    auto reader = JsonReader(content.str());
+    auto ret = Baseline();
+    reader.read_object([&](std::string key) {
+        if(key == "speed_tolerance")
+            ret.speed_tolerance = reader.read_number();
+        else if(key == "allocation_tolerance")
+            ret.allocation_tolerance = reader.read_number();
+        else if(key == "workloads") {
+            reader.read_array([&]() {
+                std::string name;
+                auto measurement = Measurement();
+                reader.read_object([&](std::string field) {
+                    if(field == "name")
+                        name = reader.read_string();
+                    else if(field == "shots_per_second")
+                        measurement.shots_per_second = reader.read_number();
+                    else if(field == "allocations_per_shot")
+                        measurement.allocations_per_shot = reader.read_number();
+                    else
+                        throw std::runtime_error(path + ": unknown workload field \"" + field + "\"");
+                });
+                ret.workloads[name] = measurement;
+            });
+        } else {
+            throw std::runtime_error(path + ": unknown key \"" + key + "\"");
+        }
+    });
+    return ret;
+}
+
+void write_json(
+    std::string path,
+    double speed_tolerance,
+    double allocation_tolerance,
+    const std::vector<Workload>& workloads,
+    const std::vector<Measurement>& measurements,
+    const Baseline* baseline
+) {
+    std::ofstream file(path);
+    if(!file.is_open())
+        throw std::runtime_error(std::string("Cannot write: ") + path);
+    file << std::setprecision(6);
+    file << "{\n    \"speed_tolerance\": " << speed_tolerance << ",\n    \"allocation_tolerance\": " << allocation_tolerance << ",\n    \"workloads\": [\n";
+    for(int k = 0; k < (int)workloads.size(); k++) {
+        file << "        {\"name\": \"" << workloads[k].name << "\", \"shots_per_second\": " << measurements[k].shots_per_second
+             << ", \"allocations_per_shot\": " << measurements[k].allocations_per_shot;
+        // a report also carries the baseline it was compared with
+        if(baseline && baseline->workloads.count(workloads[k].name)) {
+            auto& reference = baseline->workloads.at(workloads[k].name);
+            file << ", \"baseline_shots_per_second\": " << reference.shots_per_second
+                 << ", \"baseline_allocations_per_shot\": " << reference.allocations_per_shot;
+        }
+        file << "}" << (k + 1 < (int)workloads.size() ? "," : "") << "\n";
+    }
+    file << "    ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    std::string baseline_path, report_path;
+    bool update = false;
+    double min_time = 0.5;
+    double speed_tolerance = -1, allocation_tolerance = -1;
+    for(int n = 1; n < argc; n++) {
+        std::string argument = argv[n];
+        bool has_value = n + 1 < argc;
+        if(argument == "--baseline" && has_value)
+            baseline_path = argv[++n];
+        else if(argument == "--report" && has_value)
+            report_path = argv[++n];
+        else if(argument == "--min_time" && has_value)
+            min_time = std::stod(argv[++n]);
+        else if(argument == "--speed_tolerance" && has_value)
+            speed_tolerance = std::stod(argv[++n]);
+        else if(argument == "--allocation_tolerance" && has_value)
+            allocation_tolerance = std::stod(argv[++n]);
+        else if(argument == "--update")
+            update = true;
+        else {
+            std::cerr << "usage: " << argv[0] << " --baseline <json> [--update] [--report <json>] [--min_time s]"
+                      << " [--speed_tolerance f] [--allocation_tolerance f]" << std::endl;
+            return 2;
+        }
+    }
+    if(baseline_path.empty()) {
+        std::cerr << "a baseline is required" << std::endl;
+        return 2;
+    }
+
+    try {
+        auto workloads = make_workloads();
+        auto measurements = std::vector<Measurement>();
+        for(auto& workload: workloads)
+            measurements.push_back(measure(workload, min_time));
+
+        if(update) {
+            auto defaults = Baseline();
+            write_json(
+                baseline_path,
+                speed_tolerance >= 0 ? speed_tolerance : defaults.speed_tolerance,
+                allocation_tolerance >= 0 ? allocation_tolerance : defaults.allocation_tolerance,
+                workloads, measurements, nullptr
+            );
+            std::cout << "baseline written to " << baseline_path << std::endl;
+            return 0;
+        }
+
+        auto baseline = read_baseline(baseline_path);
+        if(speed_tolerance >= 0)
+            baseline.speed_tolerance = speed_tolerance;
+        if(allocation_tolerance >= 0)
+            baseline.allocation_tolerance = allocation_tolerance;
+
+        bool regressed = false;
+        std::cout << std::left << std::setw(22) << "workload" << std::right << std::setw(14) << "shots/s" << std::setw(14) << "baseline"
+                  << std::setw(9) << "change" << std::setw(12) << "allocs" << std::setw(12) << "baseline" << "  status" << std::endl;
+        std::cout << std::fixed;
+        for(int k = 0; k < (int)workloads.size(); k++) {
+            auto& name = workloads[k].name;
+            auto& current = measurements[k];
+            std::cout << std::left << std::setw(22) << name << std::right << std::setprecision(0) << std::setw(14) << current.shots_per_second;
+            if(!baseline.workloads.count(name)) {
+                std::cout << std::setw(14) << "-" << std::setw(9) << "-" << std::setprecision(1) << std::setw(12) << current.allocations_per_shot
+                          << std::setw(12) << "-" << "  new" << std::endl;
+                continue;
+            }
+            auto& reference = baseline.workloads[name];
+            double change = current.shots_per_second / reference.shots_per_second - 1;
+            bool slower = change < -baseline.speed_tolerance;
+            bool allocating = current.allocations_per_shot > reference.allocations_per_shot * (1 + baseline.allocation_tolerance) + 1e-9;
+            regressed = regressed || slower || allocating;
+            std::cout << std::setw(14) << reference.shots_per_second << std::setprecision(1) << std::setw(8) << 100 * change << "%"
+                      << std::setw(12) << current.allocations_per_shot << std::setw(12) << reference.allocations_per_shot << "  "
+                      << (slower ? (allocating ? "SLOWER MORE_ALLOCATIONS" : "SLOWER") : (allocating ? "MORE_ALLOCATIONS" : "ok")) << std::endl;
+        }
+        for(auto& entry: baseline.workloads) {
+            bool found = std::any_of(workloads.begin(), workloads.end(), [&entry](const Workload& workload) { return workload.name == entry.first; });
+            if(!found)
+                std::cout << std::left << std::setw(22) << entry.first << "  missing, only in the baseline" << std::endl;
+        }
+        if(!report_path.empty())
+            write_json(report_path, baseline.speed_tolerance, baseline.allocation_tolerance, workloads, measurements, &baseline);
+        if(regressed) {
+            std::cout << "regression: slower than " << 100 * baseline.speed_tolerance << "% or more allocations than "
+                      << 100 * baseline.allocation_tolerance << "% above the baseline" << std::endl;
+            return 1;
+        }
+        std::cout << "no regression" << std::endl;
+    }
+    catch(const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 2;
+    }
+    return 0;
+}
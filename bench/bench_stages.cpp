@@ -0,0 +1,156 @@
+#include "bench_util.hpp"
+#include "decoder.hpp"
+#include "Matching.h"
+
+#include <benchmark/benchmark.h>
+
+namespace Err = ErrorDynamics;
+namespace Mt = Decoder::Matching;
+
+static void stage_arguments(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgsProduct({Bench::sizes, Bench::rates})->ArgNames({"d", "p_1e-3"});
+}
+
+static double rate(const benchmark::State& state) {
+    return state.range(1) * 1e-3;
+}
+
+static void BM_GenerateError(benchmark::State& state) {
+    int d = state.range(0);
+    auto model = Bench::make_error_model(rate(state), false);
+    auto shape = Err::CodeScheme::PlanarShape(d, d);
+    for(auto _: state)
+        benchmark::DoNotOptimize(model->generate_planar_error(shape));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GenerateError)->Apply(stage_arguments);
+
+static void BM_AddDataError(benchmark::State& state) {
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto scheme = Err::CodeScheme::PlanarScheme(d);
+    int n = 0;
+    for(auto _: state)
+        scheme.add_data_error(pool[n++ % Bench::pool_size].second);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AddDataError)->Apply(stage_arguments);
+
+static void BM_GetSyndrome(benchmark::State& state) {
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto scheme = Err::CodeScheme::PlanarScheme(d);
+    scheme.add_data_error(pool[0].second);
+    for(auto _: state)
+        benchmark::DoNotOptimize(scheme.get_syndrome());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetSyndrome)->Apply(stage_arguments);
+
+static void BM_Step(benchmark::State& state) {
+    int d = state.range(0);
+    auto code = Err::PlanarSurfaceCode(d, Bench::make_error_model(rate(state), false));
+    for(auto _: state) {
+        code.step();
+        code.reset();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Step)->Apply(stage_arguments);
+
+static void BM_GetData(benchmark::State& state) {
+    // d noisy rounds, as the 3d decoders see them
+    int d = state.range(0);
+    auto code = Err::PlanarSurfaceCode(d, Bench::make_error_model(rate(state), true));
+    code.step(d);
+    for(auto _: state)
+        benchmark::DoNotOptimize(code.get_data());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetData)->Apply(stage_arguments);
+
+static void BM_GetGraph(benchmark::State& state) {
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto shape = Err::CodeScheme::PlanarShape(d, d);
+    auto decoder = Mt::StandardMWPMDecoder(rate(state), false, shape);
+    int n = 0;
+    for(auto _: state)
+        benchmark::DoNotOptimize(Bench::make_graph(decoder, pool[n++ % Bench::pool_size], shape));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetGraph)->Apply(stage_arguments);
+
+static void BM_BlossomSolve(benchmark::State& state) {
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto shape = Err::CodeScheme::PlanarShape(d, d);
+    auto decoder = Mt::StandardMWPMDecoder(rate(state), false, shape);
+    auto graphs = std::vector<std::shared_ptr<Mt::SyndromeGraph>>();
+    double vertices = 0;
+    for(auto& data: pool) {
+        graphs.push_back(Bench::make_graph(decoder, data, shape));
+        vertices += graphs.back()->graph.GetNumVertices();
+    }
+    int n = 0;
+    for(auto _: state) {
+        auto& graph = graphs[n++ % Bench::pool_size];
+        auto matching = MWPM::Matching(graph->graph);
+        benchmark::DoNotOptimize(matching.SolveMinimumCostPerfectMatching(graph->weight));
+    }
+    state.counters["vertices"] = vertices / Bench::pool_size;
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_BlossomSolve)->Apply(stage_arguments);
+
+static void BM_MatchingToCorrection(benchmark::State& state) {
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto shape = Err::CodeScheme::PlanarShape(d, d);
+    auto decoder = Mt::StandardMWPMDecoder(rate(state), false, shape);
+    auto graphs = std::vector<std::shared_ptr<Mt::SyndromeGraph>>();
+    auto matchings = std::vector<std::list<int>>();
+    for(auto& data: pool) {
+        graphs.push_back(Bench::make_graph(decoder, data, shape));
+        auto matching = MWPM::Matching(graphs.back()->graph);
+        matchings.push_back(matching.SolveMinimumCostPerfectMatching(graphs.back()->weight).first);
+    }
+    int n = 0;
+    for(auto _: state) {
+        int k = n++ % Bench::pool_size;
+        benchmark::DoNotOptimize(Mt::matching_to_correction(graphs[k], shape, matchings[k]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MatchingToCorrection)->Apply(stage_arguments);
+
+static void BM_Decode(benchmark::State& state) {
+    // every matching stage together
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto decoder = Mt::StandardMWPMDecoder(rate(state), false, Err::CodeScheme::PlanarShape(d, d));
+    int n = 0;
+    for(auto _: state)
+        benchmark::DoNotOptimize(decoder(pool[n++ % Bench::pool_size]));
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Decode)->Apply(stage_arguments);
+
+static void BM_DecodeHybrid(benchmark::State& state) {
+    // BM_Decode behind the local predecoder
+    int d = state.range(0);
+    auto pool = Bench::make_data_pool(d, rate(state), 1);
+    auto shape = Err::CodeScheme::PlanarShape(d, d);
+    auto decoder = Decoder::Hybrid::HybridDecoder(
+        std::make_shared<Decoder::Hybrid::LocalPredecoder>(shape, false),
+        std::make_shared<Mt::StandardMWPMDecoder>(rate(state), false, shape)
+    );
+    int n = 0;
+    for(auto _: state)
+        benchmark::DoNotOptimize(decoder(pool[n++ % Bench::pool_size]));
+    state.SetItemsProcessed(state.iterations());
+    state.counters["defect_reduction"] = decoder.defect_reduction();
+}
+BENCHMARK(BM_DecodeHybrid)->Apply(stage_arguments);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Bench {
+
+// every stage is measured at these lattice sizes, and at these error rates in units of 1e-3
+inline const std::vector<int64_t> sizes = {7, 11, 15, 19, 23, 27};
+inline const std::vector<int64_t> rates = {10, 30};
+const unsigned long long seed = 2023;
+const int pool_size = 256;
+
+inline std::shared_ptr<ErrorDynamics::ErrorModel::ErrorModelBase> make_error_model(double p, bool measurement_error) {
+    auto ret = std::make_shared<ErrorDynamics::ErrorModel::IIDError>(p / 3, p / 3, p / 3, measurement_error ? p * 2 / 3 : 0);
+    ret->seed(seed);
+    return ret;
+}
+
+// pool_size shots of the given number of rounds, the same ones on every run
+inline std::vector<ErrorDynamics::PlanarData> make_data_pool(int d, double p, int rounds) {
+    auto code = ErrorDynamics::PlanarSurfaceCode(d, make_error_model(p, rounds > 1));
+    auto ret = std::vector<ErrorDynamics::PlanarData>();
+    for(int _ = 0; _ < pool_size; _++) {
+        code.step(rounds);
+        ret.push_back(code.get_data());
+        code.reset();
+    }
+    return ret;
+}
+
+// the heap allocations so far, of the calling thread in an instrumented build, defined in allocation_count.cpp
+unsigned long long allocations();
+
+// the graph of StandardMWPMDecoder, for perfect measurements
+inline std::shared_ptr<Decoder::Matching::SyndromeGraph> make_graph(
+    Decoder::Matching::StandardMWPMDecoder& decoder,
+    ErrorDynamics::PlanarData data,
+    ErrorDynamics::CodeScheme::PlanarShape shape
+) {
+    namespace Mt = Decoder::Matching;
+    return Mt::get_graph(
+        data,
+        shape,
+        false,
+        [&decoder](Mt::PlanarIndex3d idx_a, Mt::PlanarIndex3d idx_b) { return decoder.distance_function(idx_a, idx_b); },
+        [&decoder](Mt::PlanarIndex3d idx) { return decoder.edge_distance_function_space(idx); },
+        [&decoder, data](Mt::PlanarIndex3d idx) { return decoder.edge_distance_function_time(idx, data.first->size()); }
+    );
+}
+
+}
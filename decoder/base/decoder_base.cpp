@@ -1,5 +1,6 @@
 #include "decoder_base.hpp"
 #include "error_dynamics.hpp"
+#include "instrument.hpp"
 #include <vector>
 #include <memory>
 
@@ -14,6 +15,8 @@ std::vector<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> DecoderBase
 }
 
 std::vector<ErrorDynamics::PlanarData> BatchDecoder::generate_batch(std::shared_ptr<ErrorDynamics::PlanarSurfaceCode> code, int batch_size, int step) {
+    INSTRUMENT_TIME(GENERATE_BATCH);
+    INSTRUMENT_COUNT(BATCHES, 1);
     auto batch_data = std::vector<ErrorDynamics::PlanarData>(0);
     for(int _ = 0; _ < batch_size; _++) {
         code->step(step);
@@ -0,0 +1,84 @@
+#include "batching_decoder.hpp"
+#include "exception.hpp"
+#include <vector>
+
+namespace Decoder::Batching {
+
+namespace Err = ErrorDynamics;
+
+BatchingDecoder::BatchingDecoder(std::shared_ptr<BatchDecoder> _decoder, int _max_batch, double _max_wait)
+    : decoder(_decoder), max_batch(_max_batch), max_wait((long long)(_max_wait * 1e3)), stopped(false), batches(0), shots(0) {
+    if(max_batch <= 0 || _max_wait < 0)
+        throw Err::Util::BadShape(std::string("A batching decoder needs a positive batch size and a wait of at least zero."));
+    dispatcher = std::thread(&BatchingDecoder::dispatch, this);
+}
+
+BatchingDecoder::~BatchingDecoder() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    arrived.notify_all();
+    dispatcher.join();
+}
+
+std::future<std::shared_ptr<Err::CodeScheme::PlanarError>> BatchingDecoder::submit(Err::PlanarData data) {
+    auto request = Request();
+    request.data = data;
+    request.arrival = std::chrono::steady_clock::now();
+    auto ret = request.result.get_future();
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(std::move(request));
+        // only the first shot of a batch and a full batch change what the dispatcher waits for
+        wake = pending.size() == 1 || (int)pending.size() >= max_batch;
+    }
+    if(wake)
+        arrived.notify_one();
+    return ret;
+}
+
+std::shared_ptr<Err::CodeScheme::PlanarError> BatchingDecoder::operator()(Err::PlanarData data) {
+    return submit(data).get();
+}
+
+void BatchingDecoder::dispatch() {
+    auto requests = std::vector<Request>();
+    auto datas = std::vector<Err::PlanarData>();
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            arrived.wait(lock, [this]() { return stopped || !pending.empty(); });
+            if(pending.empty())
+                return;
+            // the queued shots go out on stop without waiting for more
+            auto deadline = pending.front().arrival + max_wait;
+            arrived.wait_until(lock, deadline, [this]() { return stopped || (int)pending.size() >= max_batch; });
+            int size = std::min((int)pending.size(), max_batch);
+            for(int k = 0; k < size; k++) {
+                requests.push_back(std::move(pending.front()));
+                pending.pop_front();
+            }
+        }
+        for(auto& request: requests)
+            datas.push_back(request.data);
+        try {
+            auto corrections = (*decoder)(datas);
+            if(corrections.size() != requests.size())
+                throw Err::Util::BadShape(std::string("The batch decoder returned a correction per shot of another size."));
+            for(int k = 0; k < (int)requests.size(); k++)
+                requests[k].result.set_value(corrections[k]);
+        }
+        catch(...) {
+            for(auto& request: requests)
+                request.result.set_exception(std::current_exception());
+        }
+        batches++;
+        shots += requests.size();
+        requests.clear();
+        datas.clear();
+    }
+}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "error_dynamics.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Decoder::Batching {
+
+class BatchingDecoder: public DecoderBase {
+    /*
+    Lets any number of threads query one BatchDecoder with single shots. A dispatcher
+    thread gathers the queued shots into batches of at most max_batch, sends a batch off
+    as soon as it is full or its oldest shot has waited max_wait, and hands every
+    correction back through the future of its shot. The wrapped decoder is only ever
+    called from the dispatcher thread.
+
+    An MLDecoder takes the GIL on the dispatcher thread. With an embedded interpreter the
+    thread that started it holds the GIL, so it has to release it (py::gil_scoped_release)
+    around the threads that submit and until the BatchingDecoder is destroyed, or the
+    dispatcher waits for it forever; see example/demo_batching_ml_decoder.cpp.
+    */
+    std::shared_ptr<BatchDecoder> decoder;
+    int max_batch;
+    std::chrono::nanoseconds max_wait;
+
+    struct Request {
+        ErrorDynamics::PlanarData data;
+        std::promise<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> result;
+        std::chrono::steady_clock::time_point arrival;
+    };
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::deque<Request> pending;
+    bool stopped;
+    std::atomic<long long> batches, shots;
+    std::thread dispatcher;
+
+    void dispatch();
+
+    public:
+    BatchingDecoder() = delete;
+    // max_wait in microseconds
+    BatchingDecoder(std::shared_ptr<BatchDecoder> _decoder, int _max_batch, double _max_wait);
+    ~BatchingDecoder();
+    BatchingDecoder(const BatchingDecoder&) = delete;
+    BatchingDecoder& operator=(const BatchingDecoder&) = delete;
+
+    std::future<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> submit(ErrorDynamics::PlanarData data);
+
+    using DecoderBase::operator();
+    // submit and wait
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+
+    inline long long get_batches() const { return batches; }
+    inline long long get_shots() const { return shots; }
+    inline double mean_batch() const { return batches == 0 ? 0.0 : (double)shots / (double)batches; }
+};
+
+}
@@ -0,0 +1,118 @@
+#include "cached_decoder.hpp"
+
+namespace Decoder::Cache {
+
+DefectKey::DefectKey(const ErrorDynamics::PlanarData& data) {
+    auto shape = data.second->get_shape();
+    x = shape.x(), y = shape.y();
+    t = data.first->size();
+    // FNV-1a over the shape and the defect positions
+    hash = 14695981039346656037ull;
+    auto mix = [this](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(x), mix(y), mix(t);
+    int round = 0;
+    for(auto it = data.first->cbegin(); it != data.first->cend(); round++, it++) {
+        for(int i = 0; i < x; i++) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                if((*it)->get_symptom(ErrorDynamics::CodeScheme::PlanarIndex(i, j)) == ErrorDynamics::Util::Symptom::NEGATIVE) {
+                    int pos = (round * x + i) * y + j;
+                    defects.push_back(pos);
+                    mix((uint64_t)pos);
+                }
+            }
+        }
+    }
+}
+
+DecodeCache::DecodeCache(size_t capacity, int _max_defects, int num_shards) :
+    max_defects(_max_defects), hits(0), misses(0), bypasses(0), evictions(0) {
+    if(num_shards < 1)
+        num_shards = 1;
+    capacity_per_shard = (capacity + num_shards - 1) / num_shards;
+    if(capacity_per_shard < 1)
+        capacity_per_shard = 1;
+    for(int _ = 0; _ < num_shards; _++)
+        shards.push_back(std::make_unique<Shard>());
+}
+
+bool DecodeCache::lookup(const DefectKey& key, SparseCorrection& correction) {
+    auto& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.lookup.find(key);
+    if(it == shard.lookup.end()) {
+        misses++;
+        return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    correction = it->second->second;
+    hits++;
+    return true;
+}
+
+void DecodeCache::insert(const DefectKey& key, const SparseCorrection& correction) {
+    auto& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.lookup.find(key);
+    if(it != shard.lookup.end()) { // another thread inserted the same pattern meanwhile
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return;
+    }
+    shard.lru.emplace_front(key, correction);
+    shard.lookup.emplace(key, shard.lru.begin());
+    while(shard.lru.size() > capacity_per_shard) {
+        shard.lookup.erase(shard.lru.back().first);
+        shard.lru.pop_back();
+        evictions++;
+    }
+}
+
+size_t DecodeCache::size() {
+    size_t ret = 0;
+    for(auto& shard: shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        ret += shard->lru.size();
+    }
+    return ret;
+}
+
+void DecodeCache::clear() {
+    for(auto& shard: shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->lru.clear();
+        shard->lookup.clear();
+    }
+    hits = 0, misses = 0, bypasses = 0, evictions = 0;
+}
+
+CachedDecoder::CachedDecoder(std::shared_ptr<DecoderBase> _decoder, std::shared_ptr<DecodeCache> _cache) :
+    decoder(_decoder), cache(_cache) {}
+
+std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> CachedDecoder::operator() (ErrorDynamics::PlanarData data) {
+    auto key = DefectKey(data);
+    if(!cache->cacheable(key)) {
+        cache->count_bypass();
+        return (*decoder)(data);
+    }
+
+    auto sparse = SparseCorrection();
+    if(cache->lookup(key, sparse)) {
+        auto list = std::vector<int>(key.x * key.y, 0);
+        for(auto it = sparse.cbegin(); it != sparse.cend(); it++)
+            list[it->first] = it->second;
+        return std::make_shared<ErrorDynamics::CodeScheme::PlanarError>(key.x, key.y, list);
+    }
+
+    auto correction = (*decoder)(data);
+    auto list = correction->to_vector();
+    for(int idx = 0; idx < (int)list.size(); idx++) {
+        if(list[idx] != (int)ErrorDynamics::Util::Pauli::I)
+            sparse.push_back(std::make_pair(idx, list[idx]));
+    }
+    cache->insert(key, sparse);
+    return correction;
+}
+
+}
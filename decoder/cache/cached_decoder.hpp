@@ -0,0 +1,102 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "error_dynamics.hpp"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Decoder::Cache {
+
+struct DefectKey {
+    /*
+    Canonical form of a syndrome history: the shape, the number of rounds and
+    the sorted list of defect positions, each encoded as t * x * y + i * y + j.
+    */
+    int x, y, t;
+    std::vector<int> defects;
+    uint64_t hash;
+
+    DefectKey(const ErrorDynamics::PlanarData& data);
+    inline bool operator==(const DefectKey& other) const {
+        return hash == other.hash && x == other.x && y == other.y && t == other.t && defects == other.defects;
+    }
+};
+
+struct DefectKeyHash {
+    inline size_t operator()(const DefectKey& key) const { return (size_t)key.hash; }
+};
+
+// sparse correction: (i * y + j, pauli) for every non-identity data qubit
+using SparseCorrection = std::vector<std::pair<int, int>>;
+
+class DecodeCache {
+    /*
+    A thread-safe, size-bounded LRU map from defect patterns to corrections.
+    The entries are spread over several independently locked shards so that
+    many sweep threads can share one cache without serializing on a mutex.
+    A cache must only be shared between decoders with identical parameters.
+    */
+    struct Shard {
+        std::mutex mutex;
+        std::list<std::pair<DefectKey, SparseCorrection>> lru;
+        std::unordered_map<DefectKey, std::list<std::pair<DefectKey, SparseCorrection>>::iterator, DefectKeyHash> lookup;
+    };
+
+    size_t capacity_per_shard;
+    int max_defects;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<uint64_t> hits, misses, bypasses, evictions;
+
+    inline Shard& shard_of(const DefectKey& key) { return *shards[key.hash % shards.size()]; }
+
+    public:
+    DecodeCache() = delete;
+    // patterns with more than max_defects defects are never cached (max_defects < 0: no limit)
+    DecodeCache(size_t capacity, int max_defects = 16, int num_shards = 16);
+
+    // return true and fill the correction if the key is cached
+    bool lookup(const DefectKey& key, SparseCorrection& correction);
+    void insert(const DefectKey& key, const SparseCorrection& correction);
+    inline bool cacheable(const DefectKey& key) const {
+        return max_defects < 0 || (int)key.defects.size() <= max_defects;
+    }
+    inline void count_bypass() { bypasses++; }
+
+    size_t size();
+    void clear();
+
+    inline uint64_t get_hits() const { return hits; }
+    inline uint64_t get_misses() const { return misses; }
+    inline uint64_t get_bypasses() const { return bypasses; }
+    inline uint64_t get_evictions() const { return evictions; }
+    // fraction of all decodes answered from the cache, bypassed queries included
+    inline double hit_rate() const {
+        uint64_t total = hits + misses + bypasses;
+        return total == 0 ? 0.0 : (double)hits / (double)total;
+    }
+};
+
+class CachedDecoder: public DecoderBase {
+    /*
+    Put a DecodeCache in front of any decoder. On a miss the wrapped decoder is
+    queried and its correction stored in sparse form.
+    */
+    std::shared_ptr<DecoderBase> decoder;
+    std::shared_ptr<DecodeCache> cache;
+
+    public:
+    CachedDecoder() = delete;
+    CachedDecoder(std::shared_ptr<DecoderBase> _decoder, std::shared_ptr<DecodeCache> _cache);
+
+    using DecoderBase::operator();
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+
+    inline std::shared_ptr<DecodeCache> get_cache() const { return cache; }
+};
+
+}
@@ -2,4 +2,9 @@
 
 #include "decoder_base.hpp"
 #include "matching_decoder.hpp"
-#include "machine_learning.hpp"
\ No newline at end of file
+#include "machine_learning.hpp"
+#include "cache.hpp"
+#include "erasure.hpp"
+#include "neural.hpp"
+#include "batching.hpp"
+#include "hybrid.hpp"
\ No newline at end of file
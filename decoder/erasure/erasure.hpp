@@ -0,0 +1,4 @@
+#pragma once
+
+#include "peeling_decoder.hpp"
+#include "erasure_decoder.hpp"
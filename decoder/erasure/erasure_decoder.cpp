@@ -0,0 +1,60 @@
+#include "erasure_decoder.hpp"
+
+namespace Decoder::Erasure {
+
+namespace Cs = ErrorDynamics::CodeScheme;
+
+ErasureDecoder::ErasureDecoder(
+    double px,
+    double py,
+    double pz,
+    double pm,
+    bool _measurement_error,
+    Cs::PlanarShape _shape) :
+    measurement_error(_measurement_error),
+    peeling_decoder(_shape),
+    matching_decoder(px, py, pz, pm, _measurement_error, _shape),
+    peeled(0), matched(0) {
+    base_weight[0] = matching_decoder.get_weight(0);
+    base_weight[1] = matching_decoder.get_weight(1);
+    erasure = std::make_shared<Cs::PlanarErasure>(_shape.x(), _shape.y());
+}
+
+ErasureDecoder::ErasureDecoder(
+    double p,
+    bool _measurement_error,
+    Cs::PlanarShape _shape) :
+    ErasureDecoder::ErasureDecoder(p, p, p, (_measurement_error ? p * 2 / 3 : 1), _measurement_error, _shape) {}
+
+std::shared_ptr<Cs::PlanarError> ErasureDecoder::operator() (ErrorDynamics::PlanarData data) {
+    return this->operator()(data, erasure);
+}
+
+std::shared_ptr<Cs::PlanarError> ErasureDecoder::operator() (
+    ErrorDynamics::PlanarData data,
+    std::shared_ptr<Cs::PlanarErasure> _erasure
+) {
+    if(!measurement_error) {
+        auto result = peeling_decoder.peel(data, _erasure);
+        if(result.first) {
+            peeled++;
+            return result.second;
+        }
+    }
+
+    matched++;
+    auto shape = _erasure->get_shape();
+    auto weight_x = base_weight[0], weight_z = base_weight[1];
+    for(int i = 0; i < shape.x(); i++) {
+        for(int j = i % 2; j < shape.y(); j += 2) {
+            if(_erasure->is_erased(Cs::PlanarIndex(i, j))) {
+                weight_x[i * shape.y() + j] = 0;
+                weight_z[i * shape.y() + j] = 0;
+            }
+        }
+    }
+    matching_decoder.set_weight(weight_x, weight_z);
+    return matching_decoder(data);
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "peeling_decoder.hpp"
+#include "weighted_matching_decoder.hpp"
+#include "error_dynamics.hpp"
+#include <memory>
+
+namespace Decoder::Erasure {
+
+class ErasureDecoder: public DecoderBase {
+    /*
+    Peel first, match if peeling fails. Shots whose syndrome is explained by the
+    erased qubits alone are corrected in linear time; the others are decoded by
+    MWPM where the erased qubits get zero weight. With measurement errors the
+    peeling step is skipped.
+    */
+    bool measurement_error;
+    PeelingDecoder peeling_decoder;
+    Matching::WeightedMWPMDecoder matching_decoder;
+    std::vector<double> base_weight[2];
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> erasure;
+    long long peeled, matched;
+
+    public:
+    ErasureDecoder() = delete;
+    ErasureDecoder(double px, double py, double pz, double pm, bool _measurement_error, ErrorDynamics::CodeScheme::PlanarShape _shape);
+    ErasureDecoder(double p, bool _measurement_error, ErrorDynamics::CodeScheme::PlanarShape _shape);
+
+    inline void set_erasure(std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> _erasure) { erasure = _erasure; }
+
+    using DecoderBase::operator();
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (
+        ErrorDynamics::PlanarData data,
+        std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> _erasure
+    );
+
+    // number of shots decoded by peeling and by matching
+    inline long long get_peeled() const { return peeled; }
+    inline long long get_matched() const { return matched; }
+};
+
+}
@@ -0,0 +1,130 @@
+#include "peeling_decoder.hpp"
+#include <vector>
+
+namespace Decoder::Erasure {
+
+namespace Cs = ErrorDynamics::CodeScheme;
+
+PeelingDecoder::PeelingDecoder(Cs::PlanarShape _shape) : shape(_shape) {
+    erasure = std::make_shared<Cs::PlanarErasure>(shape.x(), shape.y());
+}
+
+std::pair<bool, std::shared_ptr<Cs::PlanarError>> PeelingDecoder::peel(
+    ErrorDynamics::PlanarData data,
+    std::shared_ptr<Cs::PlanarErasure> _erasure
+) const {
+    int x = shape.x(), y = shape.y();
+    int boundary = x * y;
+    auto correction = std::make_shared<Cs::PlanarError>(x, y);
+
+    auto defect = std::vector<int>(x * y + 1, 0);
+    for(auto it = data.first->cbegin(); it != data.first->cend(); it++) {
+        for(int i = 0; i < x; i++) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                if((*it)->get_symptom(Cs::PlanarIndex(i, j)) == ErrorDynamics::Util::Symptom::NEGATIVE)
+                    defect[i * y + j] ^= 1;
+            }
+        }
+    }
+
+    const int di[4] = {-1, 1, 0, 0};
+    const int dj[4] = {0, 0, -1, 1};
+    auto visited = std::vector<char>(x * y + 1);
+    auto parent = std::vector<int>(x * y + 1);
+    auto parent_edge = std::vector<int>(x * y + 1);
+    auto order = std::vector<int>();
+    auto boundary_edges = std::vector<std::pair<int, int>>();
+    order.reserve(x * y + 1);
+
+    // type 0: measure-Z checks (i even) and X-type flips, type 1: measure-X checks (i odd) and Z-type flips
+    for(int type = 0; type < 2; type++) {
+        auto pauli = (type == 0 ? ErrorDynamics::Util::Pauli::X : ErrorDynamics::Util::Pauli::Z);
+        std::fill(visited.begin(), visited.end(), 0);
+        order.clear();
+        boundary_edges.clear();
+
+        // the erased edges between the checks of this lattice and the boundary
+        for(int i = type; i < x; i += 2) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                for(int k = 0; k < 4; k++) {
+                    int data_i = i + di[k], data_j = j + dj[k];
+                    if(data_i < 0 || data_i >= x || data_j < 0 || data_j >= y)
+                        continue;
+                    int next_i = data_i + di[k], next_j = data_j + dj[k];
+                    if(next_i >= 0 && next_j >= 0 && next_i < x && next_j < y)
+                        continue;
+                    if(_erasure->is_erased(Cs::PlanarIndex(data_i, data_j)))
+                        boundary_edges.push_back(std::make_pair(i * y + j, data_i * y + data_j));
+                }
+            }
+        }
+
+        // grow a spanning forest of the erased edges by BFS, starting from the boundary
+        auto grow = [&](int root) {
+            size_t head = order.size();
+            visited[root] = 1;
+            parent[root] = -1;
+            order.push_back(root);
+            while(head < order.size()) {
+                int v = order[head++];
+                if(v == boundary) {
+                    for(auto it = boundary_edges.cbegin(); it != boundary_edges.cend(); it++) {
+                        if(visited[it->first])
+                            continue;
+                        visited[it->first] = 1;
+                        parent[it->first] = boundary;
+                        parent_edge[it->first] = it->second;
+                        order.push_back(it->first);
+                    }
+                    continue;
+                }
+                int vi = v / y, vj = v % y;
+                for(int k = 0; k < 4; k++) {
+                    int data_i = vi + di[k], data_j = vj + dj[k];
+                    if(data_i < 0 || data_i >= x || data_j < 0 || data_j >= y)
+                        continue;
+                    if(!_erasure->is_erased(Cs::PlanarIndex(data_i, data_j)))
+                        continue;
+                    int next_i = data_i + di[k], next_j = data_j + dj[k];
+                    int next = (next_i < 0 || next_j < 0 || next_i >= x || next_j >= y) ? boundary : next_i * y + next_j;
+                    if(visited[next])
+                        continue;
+                    visited[next] = 1;
+                    parent[next] = v;
+                    parent_edge[next] = data_i * y + data_j;
+                    order.push_back(next);
+                }
+            }
+        };
+        grow(boundary);
+        for(int i = type; i < x; i += 2) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                if(!visited[i * y + j])
+                    grow(i * y + j);
+            }
+        }
+
+        // peel the leaves, children before parents
+        for(auto it = order.crbegin(); it != order.crend(); it++) {
+            int v = *it;
+            if(parent[v] < 0 || !defect[v])
+                continue;
+            correction->mult_error(Cs::PlanarIndex(parent_edge[v] / y, parent_edge[v] % y), pauli);
+            defect[v] = 0;
+            defect[parent[v]] ^= 1;
+        }
+        defect[boundary] = 0;
+    }
+
+    for(int k = 0; k < x * y; k++) {
+        if(defect[k])
+            return std::make_pair(false, correction);
+    }
+    return std::make_pair(true, correction);
+}
+
+std::shared_ptr<Cs::PlanarError> PeelingDecoder::operator() (ErrorDynamics::PlanarData data) {
+    return peel(data, erasure).second;
+}
+
+}
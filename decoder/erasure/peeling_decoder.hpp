@@ -0,0 +1,39 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "error_dynamics.hpp"
+#include <memory>
+#include <utility>
+
+namespace Decoder::Erasure {
+
+class PeelingDecoder: public DecoderBase {
+    /*
+    The linear-time erasure decoder of Delfosse and Zemor. For both check
+    lattices, a spanning forest of the erased edges is grown, rooted at the
+    boundary whenever a tree touches it, and then peeled leaf by leaf: a leaf
+    carrying a defect flips its edge and moves the defect to its parent.
+
+    The syndrome is the sum of all the rounds, so the decoder assumes perfect
+    measurements. Peeling fails when a defect is left on a root, i.e. when the
+    syndrome cannot be explained by the erased qubits alone.
+    */
+    ErrorDynamics::CodeScheme::PlanarShape shape;
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> erasure;
+
+    public:
+    PeelingDecoder() = delete;
+    PeelingDecoder(ErrorDynamics::CodeScheme::PlanarShape _shape);
+
+    inline void set_erasure(std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> _erasure) { erasure = _erasure; }
+
+    // first: true if the whole syndrome is explained by a correction on the erased qubits
+    std::pair<bool, std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> peel(
+        ErrorDynamics::PlanarData data,
+        std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> _erasure
+    ) const;
+
+    using DecoderBase::operator();
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+};
+
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "predecoder.hpp"
+#include "hybrid_decoder.hpp"
@@ -0,0 +1,32 @@
+#include "hybrid_decoder.hpp"
+#include "instrument.hpp"
+
+namespace Decoder::Hybrid {
+
+namespace Cs = ErrorDynamics::CodeScheme;
+
+HybridDecoder::HybridDecoder(std::shared_ptr<Predecoder> _predecoder, std::shared_ptr<DecoderBase> _matcher)
+    : predecoder(_predecoder), matcher(_matcher), defects_in(0), defects_out(0), predecoded(0), matched(0), rejected(0) {}
+
+std::shared_ptr<Cs::PlanarError> HybridDecoder::operator() (ErrorDynamics::PlanarData data) {
+    int given = count_defects(data);
+    auto proposal = predecoder->predecode(data);
+    int left = count_defects(proposal.first);
+    defects_in += given;
+    if(left > given) {
+        rejected++;
+        matched++;
+        defects_out += given;
+        return (*matcher)(data);
+    }
+    INSTRUMENT_COUNT(PREDECODED, given - left);
+    defects_out += left;
+    if(left == 0) {
+        predecoded++;
+        return proposal.second;
+    }
+    matched++;
+    return proposal.second * (*matcher)(proposal.first);
+}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "predecoder.hpp"
+#include "error_dynamics.hpp"
+#include <memory>
+
+namespace Decoder::Hybrid {
+
+class HybridDecoder: public DecoderBase {
+    /*
+    Predecode, then match what is left. The matcher only sees the residual defects, so
+    its graph shrinks with the fraction the predecoder removes; shots left without defects
+    skip matching. A proposal that leaves more defects than it was given is dropped and
+    the shot is matched as it is.
+    */
+    std::shared_ptr<Predecoder> predecoder;
+    std::shared_ptr<DecoderBase> matcher;
+    long long defects_in, defects_out, predecoded, matched, rejected;
+
+    public:
+    HybridDecoder() = delete;
+    HybridDecoder(std::shared_ptr<Predecoder> _predecoder, std::shared_ptr<DecoderBase> _matcher);
+
+    using DecoderBase::operator();
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+
+    // defects given to the predecoder and passed on to the matcher
+    inline long long get_defects_in() const { return defects_in; }
+    inline long long get_defects_out() const { return defects_out; }
+    inline double defect_reduction() const { return defects_in == 0 ? 0.0 : 1.0 - (double)defects_out / (double)defects_in; }
+    // number of shots finished by the predecoder and sent to the matcher, and of the latter those whose proposal was dropped
+    inline long long get_predecoded() const { return predecoded; }
+    inline long long get_matched() const { return matched; }
+    inline long long get_rejected() const { return rejected; }
+};
+
+}
@@ -0,0 +1,126 @@
+#include "predecoder.hpp"
+#include "instrument.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace Decoder::Hybrid {
+
+namespace Err = ErrorDynamics;
+namespace Cs = ErrorDynamics::CodeScheme;
+namespace Util = ErrorDynamics::Util;
+
+int count_defects(const Err::PlanarData& data) {
+    int ret = 0;
+    for(auto& syndrome: *data.first) {
+        auto shape = syndrome->get_shape();
+        const int* list = syndrome->data();
+        for(int i = 0; i < shape.x(); i++) {
+            for(int j = (i + 1) % 2; j < shape.y(); j += 2)
+                ret += list[i * shape.y() + j];
+        }
+    }
+    return ret;
+}
+
+LocalPredecoder::LocalPredecoder(Cs::PlanarShape _shape, bool _measurement_error)
+    : shape(_shape), measurement_error(_measurement_error) {}
+
+std::pair<Err::PlanarData, std::shared_ptr<Cs::PlanarError>> LocalPredecoder::predecode(Err::PlanarData data) {
+    INSTRUMENT_TIME(PREDECODE);
+    int x = shape.x(), y = shape.y(), rounds = data.first->size();
+    int plane = x * y;
+    auto defects = std::vector<int>((size_t)rounds * plane);
+    for(int t = 0; t < rounds; t++) {
+        const int* list = (*data.first)[t]->data();
+        std::copy(list, list + plane, defects.begin() + (size_t)t * plane);
+    }
+
+    // the defects a single fault away: the same kind of stabilizer two sites over, or the same one a round before or after
+    int neighbours[6];
+    auto find_neighbours = [&](int t, int i, int j) {
+        int count = 0;
+        int n = (t * x + i) * y + j;
+        if(i >= 2 && defects[n - 2 * y]) neighbours[count++] = n - 2 * y;
+        if(i + 2 < x && defects[n + 2 * y]) neighbours[count++] = n + 2 * y;
+        if(j >= 2 && defects[n - 2]) neighbours[count++] = n - 2;
+        if(j + 2 < y && defects[n + 2]) neighbours[count++] = n + 2;
+        if(measurement_error && t >= 1 && defects[n - plane]) neighbours[count++] = n - plane;
+        if(measurement_error && t + 1 < rounds && defects[n + plane]) neighbours[count++] = n + plane;
+        return count;
+    };
+    auto degree = std::vector<int>(defects.size(), 0);
+    for(int t = 0; t < rounds; t++) {
+        for(int i = 0; i < x; i++) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                int n = (t * x + i) * y + j;
+                if(defects[n])
+                    degree[n] = find_neighbours(t, i, j);
+            }
+        }
+    }
+
+    // the pairs and the lone defects are disjoint, so the order of removal does not matter
+    auto correction = std::make_shared<Cs::PlanarError>(x, y);
+    auto removed = std::vector<int>();
+    for(int t = 0; t < rounds; t++) {
+        for(int i = 0; i < x; i++) {
+            for(int j = (i + 1) % 2; j < y; j += 2) {
+                int n = (t * x + i) * y + j;
+                if(!defects[n])
+                    continue;
+                // measure-Z stabilizers are on the even rows and see X errors, measure-X ones see Z errors
+                auto pauli = (i % 2 == 0 ? Util::Pauli::X : Util::Pauli::Z);
+                if(degree[n] == 1) {
+                    find_neighbours(t, i, j);
+                    int m = neighbours[0];
+                    if(m < n || degree[m] != 1)
+                        continue;
+                    removed.push_back(n);
+                    removed.push_back(m);
+                    if(m - n < plane) {
+                        int mi = (m % plane) / y, mj = m % y;
+                        correction->mult_error(Cs::PlanarIndex((i + mi) / 2, (j + mj) / 2), pauli);
+                    }
+                }
+                else if(degree[n] == 0) {
+                    // with measurement errors, the first and the last round are a step from the time boundary as well
+                    if(measurement_error && (t == 0 || t == rounds - 1))
+                        continue;
+                    int pos = (i % 2 == 0 ? j : i);
+                    int length = (i % 2 == 0 ? y : x);
+                    bool low = pos == 1, high = pos == length - 2;
+                    if(low == high)
+                        continue;
+                    removed.push_back(n);
+                    int edge = (low ? 0 : length - 1);
+                    correction->mult_error(i % 2 == 0 ? Cs::PlanarIndex(i, edge) : Cs::PlanarIndex(edge, j), pauli);
+                }
+            }
+        }
+    }
+
+    auto syndromes = std::make_shared<std::vector<std::shared_ptr<Cs::PlanarSyndrome>>>(0);
+    for(auto& syndrome: *data.first)
+        syndromes->push_back(std::make_shared<Cs::PlanarSyndrome>(*syndrome));
+    for(int n: removed)
+        (*syndromes)[n / plane]->change_symptom(Cs::PlanarIndex((n % plane) / y, n % y));
+    return std::make_pair(std::make_pair(syndromes, data.second), correction);
+}
+
+ModelPredecoder::ModelPredecoder(std::shared_ptr<DecoderBase> _decoder, Cs::PlanarShape _shape)
+    : decoder(_decoder), shape(_shape) {}
+
+std::pair<Err::PlanarData, std::shared_ptr<Cs::PlanarError>> ModelPredecoder::predecode(Err::PlanarData data) {
+    INSTRUMENT_TIME(PREDECODE);
+    auto correction = (*decoder)(data);
+    auto scheme = Cs::PlanarScheme(shape.x(), shape.y());
+    scheme.add_data_error(correction);
+    auto syndromes = std::make_shared<std::vector<std::shared_ptr<Cs::PlanarSyndrome>>>(0);
+    for(auto& syndrome: *data.first)
+        syndromes->push_back(std::make_shared<Cs::PlanarSyndrome>(*syndrome));
+    if(!syndromes->empty())
+        syndromes->back() = syndromes->back() ^ scheme.get_syndrome();
+    return std::make_pair(std::make_pair(syndromes, data.second), correction);
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "error_dynamics.hpp"
+#include <memory>
+#include <utility>
+
+namespace Decoder::Hybrid {
+
+// the number of NEGATIVE symptoms over all rounds
+int count_defects(const ErrorDynamics::PlanarData& data);
+
+class Predecoder {
+    /*
+    Proposes a partial correction for the defects it can explain locally and returns it
+    with the residual data, whose syndromes hold only the defects left for the matcher.
+    The correction multiplied by a correction of the residual corrects the data.
+    */
+    public:
+    virtual std::pair<ErrorDynamics::PlanarData, std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> predecode(ErrorDynamics::PlanarData data) = 0;
+    virtual ~Predecoder() = default;
+};
+
+class LocalPredecoder: public Predecoder {
+    /*
+    Removes the defects whose cheapest explanation is a single fault next to them: two
+    defects that are each other's only neighbouring defect, a step apart in space (a data
+    error between them) or in time (a measurement error), and a defect with no neighbouring
+    defect next to the boundary it can be matched to at distance one. Everything else,
+    clusters of three or more in particular, is left as it was.
+    */
+    ErrorDynamics::CodeScheme::PlanarShape shape;
+    bool measurement_error;
+
+    public:
+    LocalPredecoder() = delete;
+    LocalPredecoder(ErrorDynamics::CodeScheme::PlanarShape _shape, bool _measurement_error);
+
+    std::pair<ErrorDynamics::PlanarData, std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> predecode(ErrorDynamics::PlanarData data);
+};
+
+class ModelPredecoder: public Predecoder {
+    /*
+    Takes the correction of another decoder, e.g. a TwoLevelDecoder or a BatchingDecoder
+    in front of a network, as applied after the last round, so its syndrome is removed from
+    the last round of detection events.
+    */
+    std::shared_ptr<DecoderBase> decoder;
+    ErrorDynamics::CodeScheme::PlanarShape shape;
+
+    public:
+    ModelPredecoder() = delete;
+    ModelPredecoder(std::shared_ptr<DecoderBase> _decoder, ErrorDynamics::CodeScheme::PlanarShape _shape);
+
+    std::pair<ErrorDynamics::PlanarData, std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> predecode(ErrorDynamics::PlanarData data);
+};
+
+}
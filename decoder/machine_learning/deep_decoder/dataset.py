@@ -1,20 +1,29 @@
 import torch
-from torch.utils.data.dataset import Dataset
+from torch.utils.data.dataset import Dataset, IterableDataset
+import deep_decoder_util
+
+def weight_of(data):
+    # the weight of every shot of a batch: 1, or the number of shots a row of a ShotCompressor stands for
+    if len(data) > 2:
+        return torch.from_numpy(data[2]).float()
+    return torch.ones(data[0].shape[0])
 
 class LowLevelDataset(Dataset):
-    # input: syndrome label: correction operation
+    # input: syndrome label: correction operation weight: number of shots
     def __init__(self, split = 'train') -> None:
         super().__init__()
         self.syndrome_list = []
         self.error_list = []
+        self.weight_list = []
         self.length = 0
         self.split = split
     
     def insert_data(self, data):
-        # data: ([B, C, H, W], [B, H, W])
-        syndrome, error = data
+        # data: ([B, C, H, W], [B, H, W]) or ([B, C, H, W], [B, H, W], [B]) with the weights
+        syndrome, error = data[0], data[1]
         self.syndrome_list.append(torch.from_numpy(syndrome).float())
         self.error_list.append(torch.from_numpy(error))
+        self.weight_list.append(weight_of(data))
 
     def prepare(self):
         print(self.split)
@@ -24,30 +33,75 @@ class LowLevelDataset(Dataset):
         print(self.error_list.__len__())
         self.syndrome_tensor = torch.cat(self.syndrome_list, dim = 0)
         self.error_tensor = torch.cat(self.error_list, dim = 0)
+        self.weight_tensor = torch.cat(self.weight_list, dim = 0)
         self.length = self.error_tensor.size(0)
+        print("shots: {}, stored: {}".format(int(self.weight_tensor.sum()), self.length))
     
     def __len__(self):
         return self.length
     
     def __getitem__(self, index):
-        return (self.syndrome_tensor[index,...], self.error_tensor[index,...])
+        return (self.syndrome_tensor[index,...], self.error_tensor[index,...], self.weight_tensor[index])
+
+class ShotFileDataset(Dataset):
+    # input: syndrome label: correction operation, read on access from a shot file of generate_dataset
+    def __init__(self, path, split = 'train') -> None:
+        super().__init__()
+        self.file = deep_decoder_util.ShotFile(path)
+        self.length = len(self.file)
+        self.split = split
+
+    def prepare(self):
+        print(self.split)
+        print("shot file: {} shots, {} x {}, {} rounds, {} noise at p = {}".format(
+            self.length, self.file.x, self.file.y, self.file.rounds, self.file.noise, self.file.p))
+
+    def __len__(self):
+        return self.length
+
+    def __getitem__(self, index):
+        syndrome, error = self.file.read(index, 1, "uint8")
+        return (torch.from_numpy(syndrome[0]).float(), torch.from_numpy(error[0]).int())
+
+    def get_range(self, start, count):
+        # a contiguous batch in one call: ([B, C, H, W], [B, H, W])
+        syndrome, error = self.file.read(start, count, "uint8")
+        return (torch.from_numpy(syndrome).float(), torch.from_numpy(error).int())
+
+class ProducerDataset(IterableDataset):
+    # input: syndrome label: correction operation, fresh batches simulated by a deep_decoder_util.ShotProducer
+    # use with DataLoader(dataset, batch_size = None), the batches come from the producer
+    def __init__(self, producer) -> None:
+        super().__init__()
+        self.producer = producer
+
+    def __iter__(self):
+        for syndrome, error in self.producer:
+            yield (torch.from_numpy(syndrome).float(), torch.from_numpy(error).int())
 
 class HighLevelDataset(Dataset):
-    # input: syndrome label: correction operation
+    # input: syndrome label: logical error left by the low level decoder weight: number of shots
     def __init__(self, split = 'train') -> None:
         super().__init__()
         self.syndrome_list = []
+        self.target_list = []
+        self.weight_list = []
         self.length = 0
         self.split = split
     
     def insert_data(self, data):
+        # the physical errors are kept to label the shots once the low level decoder is trained
         self.syndrome_list.append(torch.from_numpy(data[0]).float())
+        self.target_list.append(torch.from_numpy(data[1]))
+        self.weight_list.append(weight_of(data))
     
     def prepare(self):
         print(self.split)
         print("syndrome_list length:")
         print(self.syndrome_list.__len__())
         self.syndrome_tensor = torch.cat(self.syndrome_list, dim = 0)
+        self.target_tensor = torch.cat(self.target_list, dim = 0)
+        self.weight_tensor = torch.cat(self.weight_list, dim = 0)
         self.length = self.syndrome_tensor.size(0)
     
     def __len__(self):
@@ -56,11 +110,39 @@ class HighLevelDataset(Dataset):
     def get_syndrome_tensor(self):
         return self.syndrome_tensor
 
+    def get_range(self, start, count):
+        # the syndromes and the physical errors of a contiguous batch: ([B, C, H, W], [B, H, W])
+        return (self.syndrome_tensor[start : start + count, ...], self.target_tensor[start : start + count, ...])
+
     def add_logical_error(self, logical_error):
         self.error_tensor = logical_error
     
     def __getitem__(self, index):
-        return (self.syndrome_tensor[index,...], self.error_tensor[index])
+        return (self.syndrome_tensor[index,...], self.error_tensor[index], self.weight_tensor[index])
+
+class ShotFileHighLevelDataset(Dataset):
+    # input: syndrome label: logical error left by the low level decoder, the syndromes read on access from a shot file
+    # only the labels are held in memory, one byte per shot
+    def __init__(self, path, split = 'train') -> None:
+        super().__init__()
+        self.shots = ShotFileDataset(path, split)
+        self.length = len(self.shots)
+        self.split = split
+
+    def prepare(self):
+        self.shots.prepare()
+
+    def __len__(self):
+        return self.length
+
+    def get_range(self, start, count):
+        return self.shots.get_range(start, count)
+
+    def add_logical_error(self, logical_error):
+        self.error_tensor = logical_error.to(torch.uint8)
+
+    def __getitem__(self, index):
+        return (self.shots[index][0], self.error_tensor[index].long())
 
 def tensor_stack_collate_fn(datas):
     tuple_length = len(datas[0])
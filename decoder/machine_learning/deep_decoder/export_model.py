@@ -0,0 +1,36 @@
+import struct
+import sys
+import torch
+
+# write the state_dict of a trained model for Decoder::Neural::load_tensors:
+# b"SCNN0001", the number of tensors, then per tensor its name, shape and float32 values, little endian
+
+def export(model_path, out_path):
+    try:
+        # two_level_decoder.py saves whole modules, which newer torch only loads when asked to
+        model = torch.load(model_path, map_location = "cpu", weights_only = False)
+    except TypeError:
+        model = torch.load(model_path, map_location = "cpu")
+    state = model.state_dict()
+    with open(out_path, "wb") as f:
+        f.write(b"SCNN0001")
+        f.write(struct.pack("<I", len(state)))
+        for name, tensor in state.items():
+            data = tensor.detach().cpu().float().contiguous().numpy()
+            encoded = name.encode()
+            f.write(struct.pack("<I", len(encoded)))
+            f.write(encoded)
+            f.write(struct.pack("<I", data.ndim))
+            f.write(struct.pack("<{}i".format(data.ndim), *data.shape))
+            f.write(data.astype("<f4").tobytes())
+
+def export_two_level(model_path, name):
+    # <name>_lo.pth and <name>_hi.pth of two_level_decoder.py to the <name>_lo.bin and <name>_hi.bin of TwoLevelDecoder
+    for level in ["lo", "hi"]:
+        export("{}/{}_{}.pth".format(model_path, name, level), "{}/{}_{}.bin".format(model_path, name, level))
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        print("usage: python export_model.py <model path> <name>")
+        sys.exit(1)
+    export_two_level(sys.argv[1], sys.argv[2])
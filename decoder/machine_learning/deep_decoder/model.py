@@ -29,16 +29,24 @@ class TwoLevelLLD(nn.Module):
         out = self.conv4(out) + out
         return out
     
-    def get_loss(self, logit, label):
+    def get_loss(self, logit, label, weight = None):
         # logit: (B, 4, X, Y)
         # label: (B, X, Y)
+        # weight: (B), the number of shots of each row, or None for one each; the result is the mean loss of the
+        # shots of this batch, the training draws the rows in proportion to their weight instead
         logit = logit.to(self.device)
         label = label.to(self.device)
         x = logit.size(2)
         y = logit.size(3)
         type = torch.from_numpy(deep_decoder_util.qubit_type(x, y)).to(self.device)
         label = label + type.unsqueeze(0)
-        return nn.CrossEntropyLoss(ignore_index=-100)(logit, label.long())
+        if weight is None:
+            return nn.CrossEntropyLoss(ignore_index=-100)(logit, label.long())
+        # every shot has the same sites, so this is the mean loss of the shots the rows stand for
+        loss = nn.CrossEntropyLoss(ignore_index=-100, reduction='none')(logit, label.long())
+        loss = loss.sum(dim=(1, 2)) / (label != -100).sum(dim=(1, 2))
+        weight = weight.to(self.device)
+        return (loss * weight).sum() / weight.sum()
 
 class TwoLevelHLD(nn.Module):
     def __init__(self, in_channel: int, x: int, y: int):
@@ -73,7 +81,10 @@ class TwoLevelHLD(nn.Module):
         out = self.relu(out)
         return self.fc2(out)
     
-    def get_loss(self, logit, label):
+    def get_loss(self, logit, label, weight = None):
         logit = logit.to(self.device)
         label = label.to(self.device)
-        return nn.CrossEntropyLoss()(logit, label)
\ No newline at end of file
+        if weight is None:
+            return nn.CrossEntropyLoss()(logit, label)
+        weight = weight.to(self.device)
+        return (nn.CrossEntropyLoss(reduction='none')(logit, label) * weight).sum() / weight.sum()
\ No newline at end of file
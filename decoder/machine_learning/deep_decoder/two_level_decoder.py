@@ -4,6 +4,7 @@ import dataset
 import model
 from typing import Tuple
 from torch.utils.data.dataloader import DataLoader
+from torch.utils.data.sampler import WeightedRandomSampler
 from tqdm import tqdm
 from torch.optim import Adam
 import deep_decoder_util
@@ -57,6 +58,29 @@ def receive_test_data(data: Tuple[np.ndarray, np.ndarray]):
     #high_level_datasets['test'].insert_data(data)
     pass
 
+def unpack(batch):
+    # (input, label, weight), the weight is None for datasets without one
+    if len(batch) > 2:
+        return batch
+    return (batch[0], batch[1], None)
+
+def make_dataloader(ds, batch_size, split):
+    # the rows of a ShotCompressor stand for weight shots each: the training draws them in proportion,
+    # so that every step sees the shots as the uncompressed stream would, and the validation weights them
+    weight = getattr(ds, 'weight_tensor', None)
+    if split == 'train' and weight is not None:
+        sampler = WeightedRandomSampler(weight.double(), len(ds), replacement=True)
+        return DataLoader(ds, batch_size, sampler=sampler, collate_fn=dataset.tensor_stack_collate_fn)
+    return DataLoader(ds, batch_size, True, collate_fn=dataset.tensor_stack_collate_fn)
+
+def load_shot_files(train_path, valid_path):
+    # stream both levels from the shot files of generate_dataset instead of the received batches
+    global low_level_datasets, high_level_datasets
+    low_level_datasets['train'] = dataset.ShotFileDataset(train_path, 'train')
+    low_level_datasets['valid'] = dataset.ShotFileDataset(valid_path, 'valid')
+    high_level_datasets['train'] = dataset.ShotFileHighLevelDataset(train_path, 'train')
+    high_level_datasets['valid'] = dataset.ShotFileHighLevelDataset(valid_path, 'valid')
+
 def init_dataset():
     global low_level_datasets, high_level_datasets
     for ds in [low_level_datasets, high_level_datasets]:
@@ -69,12 +93,7 @@ def init_dataset():
 def begin_training():
     global low_level_dataloaders, low_level_model, high_level_dataloaders, high_level_model
     print("Training low level decoder.")
-    low_level_dataloaders = {split: DataLoader(
-        low_level_datasets[split],
-        low_level_batch,
-        True,
-        collate_fn=dataset.tensor_stack_collate_fn
-    ) for split in ['train', 'valid']}
+    low_level_dataloaders = {split: make_dataloader(low_level_datasets[split], low_level_batch, split) for split in ['train', 'valid']}
     low_level_model = model.TwoLevelLLD(low_level_datasets['train'][0][0].size(0))
     low_level_model.to_device(working_device)
     low_level_optimizer = Adam(low_level_model.parameters(), low_level_lr)
@@ -85,7 +104,8 @@ def begin_training():
         pbar.set_description("Low  | Epoch {:03d} | Loss {} |".format(n_epoch, "------"))
         loss_total = 0
         batch_counter = 0
-        for input, label in pbar:
+        for batch in pbar:
+            input, label, _ = unpack(batch)
             loss = low_level_model.get_loss(low_level_model(input), label)
             low_level_optimizer.zero_grad()
             loss.backward()
@@ -101,20 +121,26 @@ def begin_training():
         loss_total = 0
         batch_counter = 0
         pbar.set_description("Valid Low  | Epoch {:03d} | Loss {} | Acc {}".format(n_epoch, "------", "-----"))
-        for input, label in pbar:
+        for batch in pbar:
+            input, label, weight = unpack(batch)
             logit = low_level_model(input) #(B, 4, X, Y)
-            loss = low_level_model.get_loss(logit, label)
+            loss = low_level_model.get_loss(logit, label, weight)
             _, idx = torch.topk(logit, 1, 1)
             correction = idx.squeeze(1).detach().cpu().numpy() #(B, X, Y)
             is_valid = deep_decoder_util.is_valid(deep_decoder_util.apply_physical_correction(
                 label.detach().cpu().numpy(),
                 correction
             ))
-            total_num += is_valid.shape[0]
-            correct_num += int(np.sum(is_valid))
-            loss_total += float(loss.detach().cpu())
-            batch_counter += 1
-            pbar.set_description("Valid Low  | Epoch {:03d} | Loss {:.6f} | Acc {:.5f}".format(n_epoch, loss_total / batch_counter, correct_num / total_num))
+            if weight is None:
+                shots = is_valid.shape[0]
+                correct_num += int(np.sum(is_valid))
+            else:
+                shots = float(weight.sum())
+                correct_num += float(np.sum(is_valid * weight.numpy()))
+            # the mean loss of a batch counts once per shot it stands for
+            total_num += shots
+            loss_total += float(loss.detach().cpu()) * shots
+            pbar.set_description("Valid Low  | Epoch {:03d} | Loss {:.6f} | Acc {:.5f}".format(n_epoch, loss_total / total_num, correct_num / total_num))
         pbar.close()
         acc = correct_num / total_num
         if(acc > low_best_acc):
@@ -125,25 +151,22 @@ def begin_training():
     for d in high_level_datasets.values():
         length = len(d)
         high_level_label_list = []
-        for i in range(int(length / low_level_batch)):
-            input = d.syndrome_tensor[i * low_level_batch : (i + 1) * low_level_batch, ...]
-            logit = low_level_model(input) #(B, 4, X, Y)
+        # every row, the last chunk partial, each chunk labelled from its own physical errors
+        for start in range(0, length, low_level_batch):
+            input, target = d.get_range(start, min(low_level_batch, length - start))
+            with torch.no_grad():
+                logit = low_level_model(input) #(B, 4, X, Y)
             _, idx = torch.topk(logit, 1, 1)
             correction = idx.squeeze(1).detach().cpu().numpy() #(B, X, Y)
             logical_error = deep_decoder_util.get_logical_error(deep_decoder_util.apply_physical_correction(
-                label.detach().cpu().numpy(),
+                target.detach().cpu().numpy(),
                 correction
             )) #(B, )
             high_level_label_list.append(torch.from_numpy(logical_error).long())
         d.add_logical_error(torch.cat(high_level_label_list, dim=0))
 
     print("Training high level decoder.")
-    high_level_dataloaders = {split: DataLoader(
-        high_level_datasets[split],
-        high_level_batch,
-        True,
-        collate_fn=dataset.tensor_stack_collate_fn
-    ) for split in ['train', 'valid']}
+    high_level_dataloaders = {split: make_dataloader(high_level_datasets[split], high_level_batch, split) for split in ['train', 'valid']}
     high_level_model = model.TwoLevelHLD(
         high_level_datasets['train'][0][0].size(0),
         high_level_datasets['train'][0][0].size(1),
@@ -158,7 +181,8 @@ def begin_training():
         pbar.set_description("Train High | Epoch {:03d} | Loss {} |".format(n_epoch, "------"))
         loss_total = 0
         batch_counter = 0
-        for input, label in pbar:
+        for batch in pbar:
+            input, label, _ = unpack(batch)
             loss = high_level_model.get_loss(high_level_model(input), label)
             high_level_optimizer.zero_grad()
             loss.backward()
@@ -174,16 +198,21 @@ def begin_training():
         loss_total = 0
         batch_counter = 0
         pbar.set_description("Valid High | Epoch {:03d} | Loss {} | Acc {}".format(n_epoch, "------", "-----"))
-        for input, label in pbar:
+        for batch in pbar:
+            input, label, weight = unpack(batch)
             logit = high_level_model(input) #(B, 4, X, Y)
-            loss = high_level_model.get_loss(logit, label)
+            loss = high_level_model.get_loss(logit, label, weight)
             _, idx = torch.topk(logit, 1, 1) #idx: (B, 1)
             idx = idx.squeeze(1).cpu()
-            total_num += idx.size(0)
-            correct_num += int(torch.sum((idx == label), dim=0).detach().cpu())
-            loss_total += float(loss.detach().cpu())
-            batch_counter += 1
-            pbar.set_description("Valid High | Epoch {:03d} | Loss {:.6f} | Acc {:.5f}".format(n_epoch, loss_total / batch_counter, correct_num / total_num))
+            if weight is None:
+                shots = idx.size(0)
+                correct_num += int(torch.sum((idx == label), dim=0).detach().cpu())
+            else:
+                shots = float(weight.sum())
+                correct_num += float(torch.sum((idx == label).float() * weight).detach().cpu())
+            total_num += shots
+            loss_total += float(loss.detach().cpu()) * shots
+            pbar.set_description("Valid High | Epoch {:03d} | Loss {:.6f} | Acc {:.5f}".format(n_epoch, loss_total / total_num, correct_num / total_num))
         pbar.close()
         acc = correct_num / total_num
         if(acc > high_best_acc):
@@ -1,6 +1,13 @@
 #include <pybind11/embed.h>
 #include <pybind11/numpy.h>
 #include "ml_decoder.hpp"
+#include "instrument.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
 #include <vector>
 #include <string>
 
@@ -15,86 +22,217 @@ MLDecoder::MLDecoder(std::string submodule_name) {
     module = py::module::import(("deep_decoder." + submodule_name).c_str());
 }
 
-std::pair<py::array_t<int>, py::array_t<int>> MLDecoder::to_pyarray(std::vector<ErrorDynamics::PlanarData> datas){
-    int batch_size = datas.size();
-    int length = datas[0].first->size();
-    auto shape = datas[0].second->get_shape();
+namespace {
+
+namespace Cs = ErrorDynamics::CodeScheme;
+
+ssize_t plane_width(Cs::PlanarShape shape, ArrayFormat format) {
+    return format == ArrayFormat::PACKED ? (shape.y() + 7) / 8 : shape.y();
+}
+
+size_t plane_bytes(Cs::PlanarShape shape, ArrayFormat format) {
+    return shape.x() * plane_width(shape, format) * (format == ArrayFormat::INT ? sizeof(int) : 1);
+}
 
-    auto qubit_type = std::vector<int>(shape.x() * shape.y(), 0);
-    for(int i = 0; i < shape.x(); i++) {
-        for(int j = (i + 1) % 2; j < shape.y(); j += 2) {
-            qubit_type[i * shape.y() + j] = 1;
+// write the x * y values of a plane in the given format
+void encode_plane(const int* values, Cs::PlanarShape shape, ArrayFormat format, uint8_t* out) {
+    int x = shape.x(), y = shape.y();
+    if(format == ArrayFormat::INT) {
+        std::memcpy(out, values, x * y * sizeof(int));
+    } else if(format == ArrayFormat::UINT8) {
+        for(int n = 0; n < x * y; n++)
+            out[n] = (uint8_t)values[n];
+    } else {
+        int width = plane_width(shape, format);
+        std::memset(out, 0, x * width);
+        for(int i = 0; i < x; i++) {
+            for(int j = 0; j < y; j++) {
+                if(values[i * y + j])
+                    out[i * width + j / 8] |= (uint8_t)(0x80 >> (j % 8));
+            }
         }
     }
+}
 
-    std::vector<ssize_t> shape_data = {
-        (ssize_t)batch_size,
-        (ssize_t)(1 + length),
-        (ssize_t)shape.x(),
-        (ssize_t)shape.y()
-    };
-
-    std::vector<ssize_t> shape_target = {
-        (ssize_t)batch_size,
-        (ssize_t)shape.x(),
-        (ssize_t)shape.y()
-    };
-
-    std::vector<ssize_t> stride_data = {
-        (ssize_t)((1 + length) * shape.x() * shape.y() * sizeof(int)),
-        (ssize_t)(shape.x() * shape.y() * sizeof(int)),
-        (ssize_t)(shape.y() * sizeof(int)),
-        sizeof(int)
-    };
-
-    std::vector<ssize_t> stride_target = {
-        (ssize_t)(shape.x() * shape.y() * sizeof(int)),
-        (ssize_t)(shape.y() * sizeof(int)),
-        sizeof(int)
-    };
-
-    std::shared_ptr<int[]> data(new int[batch_size * (1 + length) * shape.x() * shape.y()]);
-    std::shared_ptr<int[]> target(new int[batch_size * shape.x() * shape.y()]);
-
-    int batch_counter = 0;
-    for(auto it_batch = datas.begin(); it_batch != datas.end(); batch_counter++, it_batch++) {
-        std::memcpy(
-            data.get() + (stride_data[0] / sizeof(int)) * batch_counter,
-            qubit_type.data(),
-            shape.x() * shape.y() * sizeof(int)
-        );
-        int time_counter = 0;
-        for(auto it_time = (*it_batch).first->begin(); it_time != (*it_batch).first->end(); time_counter++, it_time++)
-            std::memcpy(
-                data.get() + 
-                (stride_data[0] / sizeof(int)) * batch_counter + 
-                (stride_data[1] / sizeof(int)) * (time_counter + 1),
-                (*it_time)->to_vector().data(),
-                shape.x() * shape.y() * sizeof(int)
-            );
-        std::memcpy(target.get() + (stride_target[0] / sizeof(int)) * batch_counter, (*it_batch).second->to_vector().data(), shape.x() * shape.y() * sizeof(int));
+// the constant qubit type channel, encoded once per shape and format
+const std::vector<uint8_t>& qubit_type_plane(Cs::PlanarShape shape, ArrayFormat format) {
+    static std::mutex mutex;
+    static std::map<std::tuple<int, int, int>, std::vector<uint8_t>> planes;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& plane = planes[std::make_tuple(shape.x(), shape.y(), (int)format)];
+    if(plane.empty()) {
+        auto qubit_type = std::vector<int>(shape.x() * shape.y(), 0);
+        for(int i = 0; i < shape.x(); i++) {
+            for(int j = (i + 1) % 2; j < shape.y(); j += 2)
+                qubit_type[i * shape.y() + j] = 1;
+        }
+        plane = std::vector<uint8_t>(plane_bytes(shape, format));
+        encode_plane(qubit_type.data(), shape, format, plane.data());
     }
+    return plane;
+}
 
+std::pair<py::array, py::array> make_arrays(int batch_size, int length, Cs::PlanarShape shape, ArrayFormat format) {
+    auto dtype = (format == ArrayFormat::INT ? py::dtype::of<int>() : py::dtype::of<uint8_t>());
+    auto data = py::array(dtype, std::vector<ssize_t>({
+        (ssize_t)batch_size, (ssize_t)(1 + length), (ssize_t)shape.x(), plane_width(shape, format)
+    }));
+    auto target = py::array(dtype, std::vector<ssize_t>({(ssize_t)batch_size, (ssize_t)shape.x(), (ssize_t)shape.y()}));
+    return std::make_pair(data, target);
+}
+
+// shot b of the arrays of make_arrays
+void write_shot(
+    const std::vector<std::shared_ptr<Cs::PlanarSyndrome>>& syndromes,
+    const Cs::PlanarError& error,
+    Cs::PlanarShape shape,
+    ArrayFormat format,
+    std::pair<py::array, py::array>& arrays,
+    int b
+) {
+    size_t plane = plane_bytes(shape, format);
+    auto data = (uint8_t*)arrays.first.mutable_data() + b * (1 + syndromes.size()) * plane;
+    auto& qubit_type = qubit_type_plane(shape, format);
+    std::memcpy(data, qubit_type.data(), plane);
+    for(size_t t = 0; t < syndromes.size(); t++)
+        encode_plane(syndromes[t]->data(), shape, format, data + (t + 1) * plane);
+    // the Paulis do not fit into a bit
+    auto target_format = (format == ArrayFormat::PACKED ? ArrayFormat::UINT8 : format);
+    auto target = (uint8_t*)arrays.second.mutable_data() + b * plane_bytes(shape, target_format);
+    encode_plane(error.data(), shape, target_format, target);
+}
+
+}
+
+std::pair<py::array_t<int>, py::array_t<int>> MLDecoder::to_pyarray(const std::vector<ErrorDynamics::PlanarData>& datas) {
+    auto arrays = to_pyarray(datas, ArrayFormat::INT);
     return std::make_pair(
-        py::array_t<int>(py::buffer_info(
-            data.get(),
-            sizeof(int),
-            py::format_descriptor<int>::format(),
-            4,
-            shape_data,
-            stride_data
-        )),
-        py::array_t<int>(py::buffer_info(
-            target.get(),
-            sizeof(int),
-            py::format_descriptor<int>::format(),
-            3,
-            shape_target,
-            stride_target
-        ))
+        py::reinterpret_borrow<py::array_t<int>>(arrays.first),
+        py::reinterpret_borrow<py::array_t<int>>(arrays.second)
     );
 }
 
+std::pair<py::array, py::array> MLDecoder::to_pyarray(const std::vector<ErrorDynamics::PlanarData>& datas, ArrayFormat format) {
+    int length = datas[0].first->size();
+    auto shape = datas[0].second->get_shape();
+    auto arrays = make_arrays(datas.size(), length, shape, format);
+    for(int b = 0; b < (int)datas.size(); b++) {
+        if((int)datas[b].first->size() != length || !(datas[b].second->get_shape() == shape))
+            throw ErrorDynamics::Util::BadShape(std::string("The shots of a batch should have the same shape and rounds."));
+        write_shot(*datas[b].first, *datas[b].second, shape, format, arrays, b);
+    }
+    return arrays;
+}
+
+std::pair<py::array, py::array> MLDecoder::generate_pyarray(
+    std::shared_ptr<ErrorDynamics::PlanarSurfaceCode> code,
+    int batch_size,
+    int step,
+    ArrayFormat format
+) {
+    INSTRUMENT_TIME(GENERATE_BATCH);
+    INSTRUMENT_COUNT(BATCHES, 1);
+    auto shape = code->get_shape();
+    auto arrays = make_arrays(batch_size, step, shape, format);
+    for(int b = 0; b < batch_size; b++) {
+        code->step(step);
+        write_shot(code->view_syndrome_changes(), code->view_last_error(), shape, format, arrays, b);
+        code->reset();
+    }
+    return arrays;
+}
+
+ShotCompressor::ShotCompressor(Cs::PlanarShape _shape, int _rounds, ArrayFormat _format)
+    : shape(_shape), rounds(_rounds), format(_format), shots(0), trivial(0) {}
+
+void ShotCompressor::add(const std::vector<std::shared_ptr<Cs::PlanarSyndrome>>& syndromes, const Cs::PlanarError& error) {
+    if((int)syndromes.size() != rounds || !(error.get_shape() == shape))
+        throw ErrorDynamics::Util::BadShape(std::string("The shots of a compressor should have its shape and rounds."));
+    int x = shape.x(), y = shape.y();
+    int defects = 0;
+    for(auto& syndrome: syndromes) {
+        const int* list = syndrome->data();
+        for(int n = 0; n < x * y; n++)
+            defects += list[n];
+    }
+    shots++;
+    if((int)defect_histogram.size() <= defects)
+        defect_histogram.resize(defects + 1, 0);
+    defect_histogram[defects]++;
+    if(defects == 0 && std::all_of(error.data(), error.data() + x * y, [](int pauli) { return pauli == 0; })) {
+        trivial++;
+        return;
+    }
+
+    // the syndrome channels and the target as to_pyarray writes them, without the constant qubit type channel
+    size_t plane = plane_bytes(shape, format);
+    auto target_format = (format == ArrayFormat::PACKED ? ArrayFormat::UINT8 : format);
+    auto key = std::string(rounds * plane + plane_bytes(shape, target_format), '\0');
+    auto out = (uint8_t*)key.data();
+    for(int t = 0; t < rounds; t++)
+        encode_plane(syndromes[t]->data(), shape, format, out + t * plane);
+    encode_plane(error.data(), shape, target_format, out + rounds * plane);
+    auto found = index.emplace(std::move(key), (int)rows.size());
+    if(found.second) {
+        rows.push_back(&found.first->first);
+        weight.push_back(1);
+    }
+    else
+        weight[found.first->second]++;
+}
+
+void ShotCompressor::add(const std::vector<ErrorDynamics::PlanarData>& datas) {
+    for(auto& data: datas)
+        add(*data.first, *data.second);
+}
+
+void ShotCompressor::generate(std::shared_ptr<ErrorDynamics::PlanarSurfaceCode> code, int batch_size) {
+    INSTRUMENT_TIME(GENERATE_BATCH);
+    INSTRUMENT_COUNT(BATCHES, 1);
+    for(int b = 0; b < batch_size; b++) {
+        code->step(rounds);
+        add(code->view_syndrome_changes(), code->view_last_error());
+        code->reset();
+    }
+}
+
+void ShotCompressor::clear() {
+    index.clear();
+    rows.clear();
+    weight.clear();
+    defect_histogram.clear();
+    shots = 0;
+    trivial = 0;
+}
+
+std::tuple<py::array, py::array, py::array_t<float>> ShotCompressor::to_pyarray() const {
+    int count = rows.size() + (trivial > 0 ? 1 : 0);
+    auto arrays = make_arrays(count, rounds, shape, format);
+    auto weights = py::array_t<float>(count);
+    size_t plane = plane_bytes(shape, format);
+    auto target_format = (format == ArrayFormat::PACKED ? ArrayFormat::UINT8 : format);
+    size_t target_plane = plane_bytes(shape, target_format);
+    auto& qubit_type = qubit_type_plane(shape, format);
+    auto data = (uint8_t*)arrays.first.mutable_data();
+    auto target = (uint8_t*)arrays.second.mutable_data();
+    auto w = weights.mutable_data();
+    for(int b = 0; b < count; b++) {
+        auto shot = data + b * (1 + rounds) * plane;
+        std::memcpy(shot, qubit_type.data(), plane);
+        if(b < (int)rows.size()) {
+            std::memcpy(shot + plane, rows[b]->data(), rounds * plane);
+            std::memcpy(target + b * target_plane, rows[b]->data() + rounds * plane, target_plane);
+            w[b] = (float)weight[b];
+        }
+        else {
+            std::memset(shot + plane, 0, rounds * plane);
+            std::memset(target + b * target_plane, 0, target_plane);
+            w[b] = (float)trivial;
+        }
+    }
+    return std::make_tuple(arrays.first, arrays.second, weights);
+}
+
 void MLDecoder::add_train_data(std::pair<py::array_t<int>, py::array_t<int>> train_data) {
     module.attr("receive_train_data")(train_data);
 }
@@ -107,6 +245,14 @@ void MLDecoder::add_test_data(std::pair<py::array_t<int>, py::array_t<int>> test
     module.attr("receive_test_data")(test_data);
 }
 
+void MLDecoder::add_train_data(const ShotCompressor& train_data) {
+    module.attr("receive_train_data")(train_data.to_pyarray());
+}
+
+void MLDecoder::add_valid_data(const ShotCompressor& valid_data) {
+    module.attr("receive_valid_data")(valid_data.to_pyarray());
+}
+
 void MLDecoder::init() {
     module.attr("init_dataset")();
 }
@@ -124,6 +270,8 @@ void MLDecoder::set_name(std::string name) {
 }
 
 std::vector<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> MLDecoder::operator()(std::vector<ErrorDynamics::PlanarData> datas) {
+    // may be called from a thread other than the interpreter's, e.g. a BatchingDecoder dispatcher
+    py::gil_scoped_acquire gil;
     auto query = MLDecoder::to_pyarray(datas);
     auto ret = py::array_t<int>(module.attr("query_data")(query.first));
     int batch_size = ret.shape(0);
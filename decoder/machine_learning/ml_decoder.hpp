@@ -3,21 +3,89 @@
 #include <vector>
 #include <utility>
 #include <string>
+#include <tuple>
+#include <unordered_map>
 #include <pybind11/embed.h>
 #include <pybind11/numpy.h>
 
 namespace Decoder::ML {
 
+/*
+The dtype of the arrays of to_pyarray and generate_pyarray:
+    INT     int32 syndromes and errors
+    UINT8   uint8 syndromes and errors
+    PACKED  the syndrome channels packed 8 per byte along y, most significant bit first
+            as numpy.packbits, so numpy.unpackbits(data, axis=-1, count=y) restores them;
+            uint8 errors
+*/
+enum class ArrayFormat {
+    INT, UINT8, PACKED
+};
+
+class ShotCompressor {
+    /*
+    Folds a stream of shots into the distinct (syndrome, error) pairs and the number of
+    shots each stands for. Most shots at small p and d have neither a defect nor an error;
+    these trivial shots are only counted, and come out as a single row weighted by their
+    count. The distinct shots are kept encoded in the format of the arrays, so the memory
+    follows the informative shots rather than all of them.
+    */
+    ErrorDynamics::CodeScheme::PlanarShape shape;
+    int rounds;
+    ArrayFormat format;
+    std::unordered_map<std::string, int> index;
+    std::vector<const std::string*> rows;
+    std::vector<long long> weight;
+    long long shots, trivial;
+    // number of shots per count of defects over all rounds
+    std::vector<long long> defect_histogram;
+
+    void add(const std::vector<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarSyndrome>>& syndromes, const ErrorDynamics::CodeScheme::PlanarError& error);
+
+    public:
+    ShotCompressor() = delete;
+    ShotCompressor(ErrorDynamics::CodeScheme::PlanarShape _shape, int _rounds, ArrayFormat _format = ArrayFormat::UINT8);
+
+    void add(const std::vector<ErrorDynamics::PlanarData>& datas);
+    // simulate batch_size shots of rounds rounds each, as add(generate_batch(code, batch_size, rounds))
+    void generate(std::shared_ptr<ErrorDynamics::PlanarSurfaceCode> code, int batch_size);
+    void clear();
+
+    inline long long get_shots() const { return shots; }
+    inline long long get_trivial() const { return trivial; }
+    inline int get_distinct() const { return rows.size(); }
+    inline const std::vector<long long>& get_defect_histogram() const { return defect_histogram; }
+
+    // data and target as to_pyarray, a row per distinct shot and one for the trivial ones, with the float32 weights
+    std::tuple<pybind11::array, pybind11::array, pybind11::array_t<float>> to_pyarray() const;
+};
+
 class MLDecoder: public BatchDecoder {
     pybind11::module module;
     public:
     MLDecoder(std::string submodule_name);
     
-    static std::pair<pybind11::array_t<int>, pybind11::array_t<int>> to_pyarray(std::vector<ErrorDynamics::PlanarData> datas);
+    /*
+    data: (batch, 1 + rounds, x, y), channel 0 is 1 on the measure qubits, the others
+    the syndrome changes; target: (batch, x, y), the Pauli errors. Both arrays are
+    allocated by numpy up front and every plane is written into them once.
+    */
+    static std::pair<pybind11::array_t<int>, pybind11::array_t<int>> to_pyarray(const std::vector<ErrorDynamics::PlanarData>& datas);
+    static std::pair<pybind11::array, pybind11::array> to_pyarray(const std::vector<ErrorDynamics::PlanarData>& datas, ArrayFormat format);
+    // as to_pyarray(generate_batch(code, batch_size, step)), written straight from the simulator without a PlanarData
+    static std::pair<pybind11::array, pybind11::array> generate_pyarray(
+        std::shared_ptr<ErrorDynamics::PlanarSurfaceCode> code,
+        int batch_size,
+        int step,
+        ArrayFormat format = ArrayFormat::INT
+    );
 
     virtual void add_train_data(std::pair<pybind11::array_t<int>, pybind11::array_t<int>> train_data);
     virtual void add_valid_data(std::pair<pybind11::array_t<int>, pybind11::array_t<int>> valid_data);
     virtual void add_test_data(std::pair<pybind11::array_t<int>, pybind11::array_t<int>> test_data);
+    // the weighted rows of ShotCompressor::to_pyarray, received as (data, target, weight)
+    virtual void add_train_data(const ShotCompressor& train_data);
+    virtual void add_valid_data(const ShotCompressor& valid_data);
 
     virtual void init();
     virtual void train();
@@ -25,6 +93,7 @@ class MLDecoder: public BatchDecoder {
     virtual void set_path(std::string path);
     virtual void set_name(std::string name);
 
+    // takes the GIL, so it may run on another thread as long as the caller's thread has released it
     virtual std::vector<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> operator()(std::vector<ErrorDynamics::PlanarData> datas);
 };
 
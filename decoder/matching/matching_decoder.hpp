@@ -1,4 +1,5 @@
 #pragma once
 
 #include "matching_util.hpp"
-#include "simple_matching_decoder.hpp"
\ No newline at end of file
+#include "simple_matching_decoder.hpp"
+#include "weighted_matching_decoder.hpp"
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "matching_util.hpp"
+#include "instrument.hpp"
 
 using namespace std;
 
@@ -12,6 +13,7 @@ shared_ptr<SyndromeGraph> get_graph(
     const edge_distance_function& edge_distance_func_space,
     const edge_distance_function& edge_distance_func_time
 ) {
+    INSTRUMENT_TIME(GRAPH);
     auto syndrome_graph = make_shared<SyndromeGraph>();
     auto syndromes = data.first;
     int total_time = syndromes->size();
@@ -76,6 +78,13 @@ shared_ptr<SyndromeGraph> get_graph(
             }
         }
     }
+    // every defect brings its boundary vertices, one in space and one in time
+    [[maybe_unused]] int defects = vertex_count / (measurement_error ? 3 : 2);
+    INSTRUMENT_COUNT(DEFECTS, defects);
+    INSTRUMENT_COUNT(VERTICES, vertex_count);
+    INSTRUMENT_COUNT(EDGES, weight.size());
+    INSTRUMENT_RECORD(DEFECTS, defects);
+    INSTRUMENT_RECORD(VERTICES, vertex_count);
     return syndrome_graph;
 }
 
@@ -84,6 +93,7 @@ std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> matching_to_correction(
     ErrorDynamics::CodeScheme::PlanarShape shape,
     const std::list<int>& matching
 ) {
+    INSTRUMENT_TIME(CORRECTION);
     auto error = std::make_shared<ErrorDynamics::CodeScheme::PlanarError>(shape.x(), shape.y());
     auto graph = syndrome_graph->graph;
     auto idx_lookup = syndrome_graph->index_lookup;
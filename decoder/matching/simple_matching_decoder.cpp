@@ -1,5 +1,6 @@
 #include "simple_matching_decoder.hpp"
 #include "Matching.h"
+#include "instrument.hpp"
 #include <cmath>
 using namespace std;
 
@@ -35,8 +36,13 @@ std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> SimpleMatchingDecoder::o
             return this->edge_distance_function_time(idx, data.first->size());
         }
     );
-    auto matching_algorithm = MWPM::Matching(syndrome_graph->graph);
-    auto matching = matching_algorithm.SolveMinimumCostPerfectMatching(syndrome_graph->weight).first;
+    INSTRUMENT_COUNT(DECODES, 1);
+    std::list<int> matching;
+    {
+        INSTRUMENT_TIME(MATCHING);
+        auto matching_algorithm = MWPM::Matching(syndrome_graph->graph);
+        matching = matching_algorithm.SolveMinimumCostPerfectMatching(syndrome_graph->weight).first;
+    }
     return matching_to_correction(syndrome_graph, shape, matching);
 }
 
@@ -0,0 +1,118 @@
+#include "weighted_matching_decoder.hpp"
+#include <functional>
+#include <limits>
+#include <queue>
+using namespace std;
+
+namespace Decoder::Matching {
+
+WeightedMWPMDecoder::WeightedMWPMDecoder(
+    double px,
+    double py,
+    double pz,
+    double pm,
+    bool measurement_error,
+    ErrorDynamics::CodeScheme::PlanarShape _shape) : WeightedMWPMDecoder::StandardMWPMDecoder(px, py, pz, pm, measurement_error, _shape) {
+    reset_weight();
+}
+
+WeightedMWPMDecoder::WeightedMWPMDecoder(
+    double p,
+    bool measurement_error,
+    ErrorDynamics::CodeScheme::PlanarShape _shape) : WeightedMWPMDecoder::StandardMWPMDecoder(p, measurement_error, _shape) {
+    reset_weight();
+}
+
+void WeightedMWPMDecoder::reset_weight() {
+    weight[0] = vector<double>(shape.x() * shape.y(), -log_px);
+    weight[1] = vector<double>(shape.x() * shape.y(), -log_pz);
+    distance_memo.clear();
+}
+
+void WeightedMWPMDecoder::set_weight(const vector<double>& x_flip_weight, const vector<double>& z_flip_weight) {
+    if((int)x_flip_weight.size() != shape.x() * shape.y() || (int)z_flip_weight.size() != shape.x() * shape.y())
+        throw ErrorDynamics::Util::BadShape(string("The weights should have one entry per qubit."));
+    weight[0] = x_flip_weight;
+    weight[1] = z_flip_weight;
+    distance_memo.clear();
+}
+
+void WeightedMWPMDecoder::set_measure_weight(const vector<double>& _measure_weight) {
+    if(!_measure_weight.empty() && (int)_measure_weight.size() != shape.x() * shape.y())
+        throw ErrorDynamics::Util::BadShape(string("The weights should have one entry per qubit."));
+    measure_weight = _measure_weight;
+}
+
+shared_ptr<vector<double>> WeightedMWPMDecoder::shortest_distance(int i, int j) {
+    int x = shape.x(), y = shape.y();
+    auto found = distance_memo.find(i * y + j);
+    if(found != distance_memo.end())
+        return found->second;
+
+    const auto& w = weight[i % 2];
+    auto dist = make_shared<vector<double>>(x * y + 2, numeric_limits<double>::infinity());
+    using entry = pair<double, int>;
+    priority_queue<entry, vector<entry>, greater<entry>> queue;
+    (*dist)[i * y + j] = 0;
+    queue.push(make_pair(0.0, i * y + j));
+
+    const int di[4] = {-1, 1, 0, 0};
+    const int dj[4] = {0, 0, -1, 1};
+    while(!queue.empty()) {
+        auto top = queue.top();
+        queue.pop();
+        int v = top.second;
+        if(top.first > (*dist)[v] || v >= x * y) // stale entry or a boundary
+            continue;
+        int vi = v / y, vj = v % y;
+        for(int k = 0; k < 4; k++) {
+            int data_i = vi + di[k], data_j = vj + dj[k];
+            if(data_i < 0 || data_i >= x || data_j < 0 || data_j >= y)
+                continue;
+            int next_i = data_i + di[k], next_j = data_j + dj[k];
+            int next;
+            if(next_i < 0 || next_j < 0)
+                next = x * y;
+            else if(next_i >= x || next_j >= y)
+                next = x * y + 1;
+            else
+                next = next_i * y + next_j;
+            double next_dist = top.first + w[data_i * y + data_j];
+            if(next_dist < (*dist)[next]) {
+                (*dist)[next] = next_dist;
+                queue.push(make_pair(next_dist, next));
+            }
+        }
+    }
+    distance_memo[i * y + j] = dist;
+    return dist;
+}
+
+std::pair<bool, double> WeightedMWPMDecoder::distance_function(PlanarIndex3d idx_a, PlanarIndex3d idx_b) {
+    if((idx_a.i() - idx_b.i()) % 2 != 0) {
+        return make_pair(false, (double)0.0);
+    }
+    auto dist = shortest_distance(idx_a.i(), idx_a.j());
+    return make_pair(true, (*dist)[idx_b.i() * shape.y() + idx_b.j()]);
+}
+
+std::pair<bool, double> WeightedMWPMDecoder::edge_distance_function_space(PlanarIndex3d idx) {
+    auto dist = shortest_distance(idx.i(), idx.j());
+    double neg = (*dist)[shape.x() * shape.y()], pos = (*dist)[shape.x() * shape.y() + 1];
+    return (neg <= pos) ? make_pair(false, neg) : make_pair(true, pos);
+}
+
+std::pair<bool, double> WeightedMWPMDecoder::edge_distance_function_time(PlanarIndex3d idx, int t_total) {
+    if(measure_weight.empty())
+        return StandardMWPMDecoder::edge_distance_function_time(idx, t_total);
+    int direction = (idx.t() < t_total / 2 ? 0 : 1);
+    int distance = (direction == 0 ? idx.t() + 1 : t_total - idx.t());
+    return make_pair(direction, distance * measure_weight[idx.i() * shape.y() + idx.j()]);
+}
+
+std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> WeightedMWPMDecoder::operator() (ErrorDynamics::PlanarData data) {
+    distance_memo.clear();
+    return SimpleMatchingDecoder::operator()(data);
+}
+
+}
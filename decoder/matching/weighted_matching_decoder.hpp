@@ -0,0 +1,50 @@
+#pragma once
+#include "simple_matching_decoder.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Decoder::Matching {
+
+class WeightedMWPMDecoder: public StandardMWPMDecoder {
+    /*
+    MWPM with an individual weight on every data qubit. The measure-Z checks form
+    a lattice whose edges are the X-type flips of the data qubits, the measure-X
+    checks form a lattice whose edges are the Z-type flips. The distance between
+    two defects, or a defect and a boundary, is the shortest path on the lattice
+    of their type, found by Dijkstra on demand and memorized for the current shot.
+
+    The correction is still drawn along straight lines by matching_to_correction:
+    on the planar code two paths with the same end points differ by a stabilizer,
+    so this only changes the representative, not the logical class.
+    */
+    protected:
+    // weight[0]: X-type flips (measure-Z lattice), weight[1]: Z-type flips (measure-X lattice), indexed by i * y + j
+    std::vector<double> weight[2];
+    // the weight of a measurement error of every check, indexed by i * y + j, empty for the uniform -log(pm)
+    std::vector<double> measure_weight;
+    // the shortest distances from a check, indexed by i * y + j, then the NEG and the POS boundary
+    std::unordered_map<int, std::shared_ptr<std::vector<double>>> distance_memo;
+
+    std::shared_ptr<std::vector<double>> shortest_distance(int i, int j);
+
+    public:
+    WeightedMWPMDecoder() = delete;
+    WeightedMWPMDecoder(double px, double py, double pz, double pm, bool measurement_error, ErrorDynamics::CodeScheme::PlanarShape _shape);
+    WeightedMWPMDecoder(double p, bool measurement_error, ErrorDynamics::CodeScheme::PlanarShape _shape);
+
+    // uniform weights -log(px) and -log(pz), the same as StandardMWPMDecoder
+    void reset_weight();
+    void set_weight(const std::vector<double>& x_flip_weight, const std::vector<double>& z_flip_weight);
+    inline const std::vector<double>& get_weight(int type) const { return weight[type]; }
+    void set_measure_weight(const std::vector<double>& _measure_weight);
+
+    std::pair<bool, double> distance_function(PlanarIndex3d idx_a, PlanarIndex3d idx_b);
+    std::pair<bool, double> edge_distance_function_space(PlanarIndex3d idx);
+    std::pair<bool, double> edge_distance_function_time(PlanarIndex3d idx, int t_total);
+
+    using DecoderBase::operator();
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+};
+
+}
@@ -0,0 +1,117 @@
+#include "network.hpp"
+#include "exception.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace Decoder::Neural {
+
+namespace Util = ErrorDynamics::Util;
+
+std::map<std::string, Tensor> load_tensors(std::string path) {
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open())
+        throw Util::BadFile(std::string("Cannot open the model: ") + path);
+    auto read = [&](void* out, size_t bytes) {
+        if(!file.read((char*)out, bytes))
+            throw Util::BadFile(path + ": a truncated model");
+    };
+    char magic[8];
+    read(magic, sizeof(magic));
+    if(std::memcmp(magic, "SCNN0001", sizeof(magic)) != 0)
+        throw Util::BadFile(path + ": not an exported model");
+    uint32_t count;
+    read(&count, sizeof(count));
+    auto ret = std::map<std::string, Tensor>();
+    for(uint32_t _ = 0; _ < count; _++) {
+        uint32_t length, ndim;
+        read(&length, sizeof(length));
+        auto name = std::string(length, '\0');
+        read(&name[0], length);
+        read(&ndim, sizeof(ndim));
+        auto tensor = Tensor();
+        tensor.shape = std::vector<int>(ndim);
+        read(tensor.shape.data(), ndim * sizeof(int));
+        size_t size = 1;
+        for(int n: tensor.shape)
+            size *= n;
+        tensor.data = std::vector<float>(size);
+        read(tensor.data.data(), size * sizeof(float));
+        ret[name] = tensor;
+    }
+    return ret;
+}
+
+static const Tensor& find_tensor(const std::map<std::string, Tensor>& tensors, std::string name, int ndim) {
+    auto it = tensors.find(name);
+    if(it == tensors.end())
+        throw Util::BadFile(std::string("The model has no tensor ") + name);
+    if((int)it->second.shape.size() != ndim)
+        throw Util::BadShape(std::string("The tensor ") + name + " should have " + std::to_string(ndim) + " dimensions");
+    return it->second;
+}
+
+Conv2d::Conv2d(const std::map<std::string, Tensor>& tensors, std::string name) {
+    auto& w = find_tensor(tensors, name + ".weight", 4);
+    auto& b = find_tensor(tensors, name + ".bias", 1);
+    out_channel = w.shape[0], in_channel = w.shape[1], kx = w.shape[2], ky = w.shape[3];
+    if(b.shape[0] != out_channel || kx % 2 == 0 || ky % 2 == 0)
+        throw Util::BadShape(name + ": expected an odd kernel and one bias per output channel");
+    weight = w.data;
+    bias = b.data;
+}
+
+void Conv2d::operator()(const float* in, int x, int y, float* out) const {
+    int px = kx / 2, py = ky / 2;
+    size_t plane = (size_t)x * y;
+    for(int o = 0; o < out_channel; o++) {
+        float* target = out + o * plane;
+        std::fill(target, target + plane, bias[o]);
+        for(int c = 0; c < in_channel; c++) {
+            const float* source = in + c * plane;
+            const float* kernel = weight.data() + ((size_t)o * in_channel + c) * kx * ky;
+            for(int di = 0; di < kx; di++) {
+                // the rows i of the output which read row i + di - px of the input
+                int i_begin = std::max(0, px - di), i_end = std::min(x, x + px - di);
+                for(int dj = 0; dj < ky; dj++) {
+                    float w = kernel[di * ky + dj];
+                    int j_begin = std::max(0, py - dj), j_end = std::min(y, y + py - dj);
+                    for(int i = i_begin; i < i_end; i++) {
+                        float* row = target + (size_t)i * y;
+                        const float* source_row = source + (size_t)(i + di - px) * y;
+                        int shift = dj - py;
+                        // contiguous in j: vectorized
+                        #pragma omp simd
+                        for(int j = j_begin; j < j_end; j++)
+                            row[j] += w * source_row[j + shift];
+                    }
+                }
+            }
+        }
+    }
+}
+
+Linear::Linear(const std::map<std::string, Tensor>& tensors, std::string name) {
+    auto& w = find_tensor(tensors, name + ".weight", 2);
+    auto& b = find_tensor(tensors, name + ".bias", 1);
+    out_features = w.shape[0], in_features = w.shape[1];
+    if(b.shape[0] != out_features)
+        throw Util::BadShape(name + ": expected one bias per output");
+    weight = w.data;
+    bias = b.data;
+}
+
+void Linear::operator()(const float* in, float* out) const {
+    for(int o = 0; o < out_features; o++) {
+        const float* row = weight.data() + (size_t)o * in_features;
+        float sum = 0;
+        #pragma omp simd reduction(+:sum)
+        for(int k = 0; k < in_features; k++)
+            sum += row[k] * in[k];
+        out[o] = bias[o] + sum;
+    }
+}
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Decoder::Neural {
+
+struct Tensor {
+    std::vector<int> shape;
+    std::vector<float> data;
+};
+
+/*
+The tensors of a state_dict written by deep_decoder/export_model.py: the magic "SCNN0001",
+the number of tensors, then per tensor its name, its shape and its float32 values, little endian.
+*/
+std::map<std::string, Tensor> load_tensors(std::string path);
+
+class Conv2d {
+    /*
+    nn.Conv2d with stride 1 and a zero padding of half the kernel: the output planes
+    have the size of the input planes. Planes are x * y floats, row by row.
+    */
+    int in_channel, out_channel, kx, ky;
+    std::vector<float> weight, bias;
+
+    public:
+    inline Conv2d() : in_channel(0), out_channel(0), kx(0), ky(0) {}
+    // the tensors <name>.weight and <name>.bias
+    Conv2d(const std::map<std::string, Tensor>& tensors, std::string name);
+
+    // in: in_channel planes, out: out_channel planes
+    void operator()(const float* in, int x, int y, float* out) const;
+
+    inline int get_in_channel() const { return in_channel; }
+    inline int get_out_channel() const { return out_channel; }
+};
+
+class Linear {
+    int in_features, out_features;
+    std::vector<float> weight, bias;
+
+    public:
+    inline Linear() : in_features(0), out_features(0) {}
+    Linear(const std::map<std::string, Tensor>& tensors, std::string name);
+
+    void operator()(const float* in, float* out) const;
+
+    inline int get_in_features() const { return in_features; }
+    inline int get_out_features() const { return out_features; }
+};
+
+inline void relu(float* data, size_t n) {
+    #pragma omp simd
+    for(size_t k = 0; k < n; k++)
+        data[k] = data[k] > 0 ? data[k] : 0;
+}
+
+}
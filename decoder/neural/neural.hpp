@@ -0,0 +1,4 @@
+#pragma once
+
+#include "network.hpp"
+#include "two_level_decoder.hpp"
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "two_level_decoder.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+
+namespace Decoder::Neural {
+
+namespace Err = ErrorDynamics;
+namespace Util = ErrorDynamics::Util;
+
+TwoLevelModel::TwoLevelModel(std::string low_path, std::string high_path) {
+    auto low_tensors = load_tensors(low_path);
+    for(int k = 0; k < 4; k++)
+        low[k] = Conv2d(low_tensors, "conv" + std::to_string(k + 1));
+    auto high_tensors = load_tensors(high_path);
+    for(int k = 0; k < 3; k++)
+        high[k] = Conv2d(high_tensors, "conv" + std::to_string(k + 1));
+    fc1 = Linear(high_tensors, "fc1");
+    fc2 = Linear(high_tensors, "fc2");
+
+    bool chained = low[3].get_in_channel() == 4 && low[3].get_out_channel() == 4 && high[0].get_in_channel() == low[0].get_in_channel()
+        && fc1.get_in_features() == high[2].get_out_channel() && fc2.get_in_features() == fc1.get_out_features() && fc2.get_out_features() == 4;
+    for(int k = 0; k < 3; k++)
+        chained = chained && low[k].get_out_channel() == low[k + 1].get_in_channel();
+    for(int k = 0; k < 2; k++)
+        chained = chained && high[k].get_out_channel() == high[k + 1].get_in_channel();
+    if(!chained)
+        throw Util::BadShape(low_path + ", " + high_path + ": the layers do not fit TwoLevelLLD and TwoLevelHLD");
+}
+
+std::shared_ptr<const TwoLevelModel> TwoLevelModel::load(std::string prefix) {
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const TwoLevelModel>> models;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& model = models[prefix];
+    if(!model)
+        model = std::make_shared<const TwoLevelModel>(prefix + "_lo.bin", prefix + "_hi.bin");
+    return model;
+}
+
+TwoLevelDecoder::TwoLevelDecoder(std::shared_ptr<const TwoLevelModel> _model, Err::CodeScheme::PlanarShape _shape)
+    : model(_model), shape(_shape) {}
+
+TwoLevelDecoder::TwoLevelDecoder(std::string prefix, Err::CodeScheme::PlanarShape _shape)
+    : TwoLevelDecoder(TwoLevelModel::load(prefix), _shape) {}
+
+namespace {
+
+// the activations of one shot, kept by every thread between decodes
+struct Workspace {
+    std::vector<float> input, first, second, third, pooled, hidden;
+};
+
+int argmax(const float* values, int n, size_t stride) {
+    int ret = 0;
+    for(int k = 1; k < n; k++) {
+        if(values[k * stride] > values[ret * stride])
+            ret = k;
+    }
+    return ret;
+}
+
+std::shared_ptr<Err::CodeScheme::PlanarError> decode(const TwoLevelModel& model, const Err::PlanarData& data, Err::CodeScheme::PlanarShape shape) {
+    thread_local Workspace workspace;
+    int x = shape.x(), y = shape.y();
+    size_t plane = (size_t)x * y;
+    int channels = model.get_in_channel();
+    auto fit = [plane](std::vector<float>& buffer, int planes) {
+        if(buffer.size() < planes * plane)
+            buffer.resize(planes * plane);
+        return buffer.data();
+    };
+
+    float* input = fit(workspace.input, channels);
+    for(int i = 0; i < x; i++) {
+        for(int j = 0; j < y; j++)
+            input[i * y + j] = (float)((i + j) % 2);
+    }
+    for(int t = 0; t < (int)data.first->size(); t++) {
+        auto values = (*data.first)[t]->data();
+        float* target = input + (t + 1) * plane;
+        for(size_t n = 0; n < plane; n++)
+            target[n] = (float)values[n];
+    }
+
+    // low level: a Pauli per site, conv4 is residual
+    float* first = fit(workspace.first, model.low[0].get_out_channel());
+    model.low[0](input, x, y, first);
+    relu(first, model.low[0].get_out_channel() * plane);
+    float* second = fit(workspace.second, model.low[1].get_out_channel());
+    model.low[1](first, x, y, second);
+    relu(second, model.low[1].get_out_channel() * plane);
+    model.low[2](second, x, y, first);
+    relu(first, 4 * plane);
+    model.low[3](first, x, y, second);
+    for(size_t n = 0; n < 4 * plane; n++)
+        second[n] += first[n];
+    auto list = std::vector<int>(plane, 0);
+    for(int i = 0; i < x; i++) {
+        for(int j = i % 2; j < y; j += 2)
+            list[i * y + j] = argmax(second + i * y + j, 4, plane);
+    }
+
+    // high level: the logical operator left over, from the mean of the last feature planes
+    first = fit(workspace.first, model.high[0].get_out_channel());
+    model.high[0](input, x, y, first);
+    relu(first, model.high[0].get_out_channel() * plane);
+    second = fit(workspace.second, model.high[1].get_out_channel());
+    model.high[1](first, x, y, second);
+    relu(second, model.high[1].get_out_channel() * plane);
+    int features = model.high[2].get_out_channel();
+    float* third = fit(workspace.third, features);
+    model.high[2](second, x, y, third);
+    relu(third, features * plane);
+    workspace.pooled.resize(features);
+    workspace.hidden.resize(model.fc1.get_out_features());
+    float* pooled = workspace.pooled.data();
+    float* hidden = workspace.hidden.data();
+    float logits[4];
+    for(int c = 0; c < features; c++) {
+        float sum = 0;
+        for(size_t n = 0; n < plane; n++)
+            sum += third[c * plane + n];
+        pooled[c] = sum / plane;
+    }
+    model.fc1(pooled, hidden);
+    relu(hidden, model.fc1.get_out_features());
+    model.fc2(hidden, logits);
+    int logical = argmax(logits, 4, 1);
+
+    // as deep_decoder_util.apply_logical_error
+    if(logical == 1 || logical == 2) {
+        for(int j = 0; j < y; j += 2)
+            list[j] = (int)((Util::Pauli)list[j] * Util::Pauli::X);
+    }
+    if(logical == 3 || logical == 2) {
+        for(int i = 0; i < x; i += 2)
+            list[i * y] = (int)((Util::Pauli)list[i * y] * Util::Pauli::Z);
+    }
+    return std::make_shared<Err::CodeScheme::PlanarError>(x, y, list);
+}
+
+}
+
+std::shared_ptr<Err::CodeScheme::PlanarError> TwoLevelDecoder::operator()(Err::PlanarData data) {
+    if((int)data.first->size() + 1 != model->get_in_channel())
+        throw Util::BadShape(std::string("The model was trained on ") + std::to_string(model->get_in_channel() - 1) + " rounds");
+    return decode(*model, data, shape);
+}
+
+std::vector<std::shared_ptr<Err::CodeScheme::PlanarError>> TwoLevelDecoder::operator()(std::vector<Err::PlanarData> datas) {
+    for(auto& data: datas) {
+        if((int)data.first->size() + 1 != model->get_in_channel())
+            throw Util::BadShape(std::string("The model was trained on ") + std::to_string(model->get_in_channel() - 1) + " rounds");
+    }
+    auto ret = std::vector<std::shared_ptr<Err::CodeScheme::PlanarError>>(datas.size());
+    #pragma omp parallel for schedule(dynamic, 1)
+    for(int k = 0; k < (int)datas.size(); k++)
+        ret[k] = decode(*model, datas[k], shape);
+    return ret;
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "decoder_base.hpp"
+#include "network.hpp"
+#include "error_dynamics.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Decoder::Neural {
+
+struct TwoLevelModel {
+    /*
+    The weights of TwoLevelLLD and TwoLevelHLD of deep_decoder/model.py, as exported by
+    export_model.py next to the trained <prefix>_lo.pth and <prefix>_hi.pth.
+    */
+    Conv2d low[4];
+    Conv2d high[3];
+    Linear fc1, fc2;
+
+    TwoLevelModel(std::string low_path, std::string high_path);
+
+    // <prefix>_lo.bin and <prefix>_hi.bin, loaded once per process and shared by every decoder
+    static std::shared_ptr<const TwoLevelModel> load(std::string prefix);
+
+    inline int get_in_channel() const { return low[0].get_in_channel(); }
+};
+
+class TwoLevelDecoder: public BatchDecoder {
+    /*
+    The two-level decoder of two_level_decoder.py without Python: the low level network
+    picks a Pauli for every data qubit, the high level network the logical operator which
+    is applied on top. The input channels are the qubit type and the syndrome changes of
+    every round, as MLDecoder::to_pyarray exports them. Decoding only reads the model,
+    so any number of threads can share it.
+    */
+    std::shared_ptr<const TwoLevelModel> model;
+    ErrorDynamics::CodeScheme::PlanarShape shape;
+
+    public:
+    TwoLevelDecoder() = delete;
+    TwoLevelDecoder(std::shared_ptr<const TwoLevelModel> _model, ErrorDynamics::CodeScheme::PlanarShape _shape);
+    TwoLevelDecoder(std::string prefix, ErrorDynamics::CodeScheme::PlanarShape _shape);
+
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> operator() (ErrorDynamics::PlanarData data);
+    std::vector<std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError>> operator()(std::vector<ErrorDynamics::PlanarData> datas);
+};
+
+}
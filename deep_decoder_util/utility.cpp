@@ -1,6 +1,8 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
+#include <cstdint>
+#include <cstring>
 #include <vector>
 #include "utility.hpp"
 #include "error_dynamics.hpp"
@@ -9,105 +11,123 @@
 namespace py = pybind11;
 namespace Err = ErrorDynamics;
 
-py::array_t<int> get_logical_error(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors
-) {
-    // physical_errors: shape (B, X, Y)
+// below this batch size the threads cost more than they save
+static const ssize_t parallel_batch = 256;
 
-    ssize_t batch_size = physical_errors.shape(0);
-    ssize_t x = physical_errors.shape(1);
-    ssize_t y = physical_errors.shape(2);
-    auto phy_err_acc = physical_errors.unchecked<3>();
-    
-    auto ret = std::vector<int>(batch_size);
-    for(int b = 0; b < batch_size; b++) {
-        int z_cnt = 0;
-        for(int j = 0; j < y; j += 2) {
-            if(phy_err_acc(b, 0, j) == 2 || phy_err_acc(b, 0, j) == 3)
-                z_cnt++;
+template<typename Array>
+static void check_errors(const Array& physical_errors) {
+    if(physical_errors.ndim() != 3)
+        throw py::value_error("The errors should be of shape (B, X, Y).");
+}
+
+template<typename T>
+static int logical_error(const T* error, ssize_t x, ssize_t y) {
+    int z_cnt = 0;
+    for(ssize_t j = 0; j < y; j += 2)
+        z_cnt += (error[j] == 2 || error[j] == 3);
+    int x_cnt = 0;
+    for(ssize_t i = 0; i < x; i += 2)
+        x_cnt += (error[i * y] == 1 || error[i * y] == 2);
+    int ret = 0;
+    if(z_cnt % 2 == 1)
+        ret = pauli_mult[ret][3];
+    if(x_cnt % 2 == 1)
+        ret = pauli_mult[ret][1];
+    return ret;
+}
+
+// PlanarError::is_valid on a plane of the batch
+template<typename T>
+static bool valid(const T* error, ssize_t x, ssize_t y) {
+    auto is_xy = [](T p) { return p == 1 || p == 2; };
+    auto is_zy = [](T p) { return p == 2 || p == 3; };
+    // measure-Z
+    for(ssize_t i = 0; i < x; i += 2) {
+        for(ssize_t j = 1; j < y; j += 2) {
+            int cnt = (i - 1 >= 0 && is_xy(error[(i - 1) * y + j])) + (i + 1 < x && is_xy(error[(i + 1) * y + j]))
+                    + is_xy(error[i * y + j - 1]) + is_xy(error[i * y + j + 1]);
+            if(cnt % 2 == 1)
+                return false;
         }
-        int x_cnt = 0;
-        for(int i = 0; i < x; i += 2) {
-            if(phy_err_acc(b, i, 0) == 1 || phy_err_acc(b, i, 0) == 2)
-                x_cnt++;
+    }
+    // measure-X
+    for(ssize_t i = 1; i < x; i += 2) {
+        for(ssize_t j = 0; j < y; j += 2) {
+            int cnt = is_zy(error[(i - 1) * y + j]) + is_zy(error[(i + 1) * y + j])
+                    + (j - 1 >= 0 && is_zy(error[i * y + j - 1])) + (j + 1 < y && is_zy(error[i * y + j + 1]));
+            if(cnt % 2 == 1)
+                return false;
         }
-        if(z_cnt == 1)
-            ret[b] = pauli_mult[ret[b]][3];
-        if(x_cnt == 1)
-            ret[b] = pauli_mult[ret[b]][1];
     }
-    return py::array_t<int>(py::buffer_info(
-        ret.data(),
-        sizeof(int),
-        py::format_descriptor<int>::format(),
-        1,
-        std::vector<ssize_t>({batch_size}),
-        std::vector<ssize_t>({sizeof(int)})
-    ));
+    return true;
 }
 
-py::array_t<int> apply_logical_error(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors,
-    py::array_t<int, py::array::forcecast | py::array::c_style> &logical_errors
-) {
-    // physical_errors: shape (B, X, Y)
-    // logical_errors: shape (B, )
+template<typename Array>
+py::array_t<int> get_logical_error(Array &physical_errors) {
+    check_errors(physical_errors);
+    ssize_t batch_size = physical_errors.shape(0);
+    ssize_t x = physical_errors.shape(1);
+    ssize_t y = physical_errors.shape(2);
+    auto ret = py::array_t<int>(batch_size);
+    auto errors = physical_errors.data();
+    int* out = ret.mutable_data();
+    {
+        py::gil_scoped_release release;
+        #pragma omp parallel for if(batch_size >= parallel_batch)
+        for(ssize_t b = 0; b < batch_size; b++)
+            out[b] = logical_error(errors + b * x * y, x, y);
+    }
+    return ret;
+}
 
+template<typename Array>
+Array apply_logical_error(Array &physical_errors, IntErrorArray &logical_errors) {
+    check_errors(physical_errors);
     ssize_t batch_size = physical_errors.shape(0);
     ssize_t x = physical_errors.shape(1);
     ssize_t y = physical_errors.shape(2);
-    auto phy_err_acc = physical_errors.unchecked<3>();
-    auto log_err_acc = logical_errors.unchecked<1>();
-
-    auto ret = std::vector<int>(batch_size * x * y);
-    std::memcpy(ret.data(), physical_errors.data(), batch_size * x * y * sizeof(int));
-    
-    for(int b = 0; b < batch_size; b++) {
-        if(log_err_acc(b) == 1 || log_err_acc(b) == 2) {
-            for(int j = 0; j < y; j += 2) {
-                ret[b * x * y + 0 * y + j] = pauli_mult[ret[b * x * y + 0 * y + j]][1];
+    if(logical_errors.ndim() != 1 || logical_errors.shape(0) != batch_size)
+        throw py::value_error("There should be one logical error per sample.");
+    auto ret = Array(std::vector<ssize_t>({batch_size, x, y}));
+    using T = typename Array::value_type;
+    auto errors = physical_errors.data();
+    auto logical = logical_errors.data();
+    T* out = ret.mutable_data();
+    {
+        py::gil_scoped_release release;
+        #pragma omp parallel for if(batch_size >= parallel_batch)
+        for(ssize_t b = 0; b < batch_size; b++) {
+            T* plane = out + b * x * y;
+            std::memcpy(plane, errors + b * x * y, x * y * sizeof(T));
+            if(logical[b] == 1 || logical[b] == 2) {
+                for(ssize_t j = 0; j < y; j += 2)
+                    plane[j] = (T)pauli_mult[(int)plane[j]][1];
             }
-        }
-        if(log_err_acc(b) == 3 || log_err_acc(b) == 2) {
-            for(int i = 0; i < x; i += 2) {
-                ret[b * x * y + i * y + 0] = pauli_mult[ret[b * x * y + i * y + 0]][3];
+            if(logical[b] == 3 || logical[b] == 2) {
+                for(ssize_t i = 0; i < x; i += 2)
+                    plane[i * y] = (T)pauli_mult[(int)plane[i * y]][3];
             }
         }
     }
-
-    return py::array_t<int>(py::buffer_info(
-        ret.data(),
-        sizeof(int),
-        py::format_descriptor<int>::format(),
-        3, 
-        std::vector<ssize_t>({batch_size, x, y}),
-        std::vector<ssize_t>({(ssize_t)sizeof(int) * x * y, (ssize_t)sizeof(int) * y, (ssize_t)sizeof(int)})
-    ));
+    return ret;
 }
 
-py::array_t<int> is_valid(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors
-) {
+template<typename Array>
+py::array_t<int> is_valid(Array &physical_errors) {
+    check_errors(physical_errors);
     ssize_t batch_size = physical_errors.shape(0);
     ssize_t x = physical_errors.shape(1);
     ssize_t y = physical_errors.shape(2);
-    auto ret = std::vector<int>(batch_size);
-
-    for(int b = 0; b < batch_size; b++) {
-        auto list = std::vector<int>(x * y);
-        std::memcpy(list.data(), physical_errors.data() + b * x * y, x * y * sizeof(int));
-        bool is_valid = std::make_shared<Err::CodeScheme::PlanarError>(x, y, list)->is_valid();
-        ret[b] = is_valid;
+    auto ret = py::array_t<int>(batch_size);
+    auto errors = physical_errors.data();
+    int* out = ret.mutable_data();
+    {
+        py::gil_scoped_release release;
+        #pragma omp parallel for if(batch_size >= parallel_batch)
+        for(ssize_t b = 0; b < batch_size; b++)
+            out[b] = valid(errors + b * x * y, x, y);
     }
-
-    return py::array_t<int>(py::buffer_info(
-        ret.data(),
-        sizeof(int),
-        py::format_descriptor<int>::format(),
-        1,
-        std::vector<ssize_t>({batch_size}),
-        std::vector<ssize_t>({sizeof(int)})
-    ));
+    return ret;
 }
 
 py::array_t<int> qubit_type(
@@ -127,32 +147,171 @@ py::array_t<int> qubit_type(
     ));
 }
 
-py::array_t<int> apply_physical_correction(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors,
-    py::array_t<int, py::array::forcecast | py::array::c_style> &corrections
-) {
-    py::array_t<int> ret = py::array_t<int>(physical_errors);
+template<typename Array>
+Array apply_physical_correction(Array &physical_errors, Array &corrections) {
+    check_errors(physical_errors);
     ssize_t batch_size = physical_errors.shape(0);
     ssize_t x = physical_errors.shape(1);
     ssize_t y = physical_errors.shape(2);
-    
-    auto phy_acc = physical_errors.unchecked<3>();
-    auto cor_acc = corrections.unchecked<3>();
-    auto ret_acc = ret.mutable_unchecked<3>();
-    for(int b = 0; b < batch_size; b++) {
-        for(int i = 0; i < x; i++) {
-            for(int j = i % 2; j < y; j += 2) {
-                ret_acc(b, i, j) = pauli_mult[phy_acc(b, i, j)][cor_acc(b, i, j)];
+    if(corrections.ndim() != 3 || corrections.shape(0) != batch_size || corrections.shape(1) != x || corrections.shape(2) != y)
+        throw py::value_error("The corrections should be of the shape of the errors.");
+    // a new array: the errors of the caller are left as they are
+    auto ret = Array(std::vector<ssize_t>({batch_size, x, y}));
+    using T = typename Array::value_type;
+    auto errors = physical_errors.data();
+    auto correction = corrections.data();
+    T* out = ret.mutable_data();
+    {
+        py::gil_scoped_release release;
+        #pragma omp parallel for if(batch_size >= parallel_batch)
+        for(ssize_t b = 0; b < batch_size; b++) {
+            for(ssize_t n = b * x * y; n < (b + 1) * x * y; n++)
+                out[n] = errors[n];
+            for(ssize_t i = 0; i < x; i++) {
+                for(ssize_t j = i % 2; j < y; j += 2) {
+                    ssize_t n = (b * x + i) * y + j;
+                    out[n] = (T)pauli_mult[(int)errors[n]][(int)correction[n]];
+                }
             }
         }
     }
     return ret;
 }
 
+template py::array_t<int> get_logical_error(IntErrorArray&);
+template py::array_t<int> get_logical_error(ErrorArray<uint8_t>&);
+template py::array_t<int> get_logical_error(ErrorArray<int8_t>&);
+template IntErrorArray apply_logical_error(IntErrorArray&, IntErrorArray&);
+template ErrorArray<uint8_t> apply_logical_error(ErrorArray<uint8_t>&, IntErrorArray&);
+template ErrorArray<int8_t> apply_logical_error(ErrorArray<int8_t>&, IntErrorArray&);
+template py::array_t<int> is_valid(IntErrorArray&);
+template py::array_t<int> is_valid(ErrorArray<uint8_t>&);
+template py::array_t<int> is_valid(ErrorArray<int8_t>&);
+template IntErrorArray apply_physical_correction(IntErrorArray&, IntErrorArray&);
+template ErrorArray<uint8_t> apply_physical_correction(ErrorArray<uint8_t>&, ErrorArray<uint8_t>&);
+template ErrorArray<int8_t> apply_physical_correction(ErrorArray<int8_t>&, ErrorArray<int8_t>&);
+
+template<typename T>
+static void unpack_shots(const Err::ShotFileReader& file, long long start, long long count, T* data, T* target) {
+    auto& header = file.get_header();
+    ssize_t plane = header.x * header.y;
+    for(long long n = 0; n < count; n++) {
+        T* shot = data + n * (1 + header.rounds) * plane;
+        for(int i = 0; i < header.x; i++) {
+            for(int j = 0; j < header.y; j++)
+                shot[i * header.y + j] = (T)((i + j) % 2);
+        }
+        file.read_shot(start + n, shot + plane, target + n * plane);
+    }
+}
+
+std::pair<py::array, py::array> read_shots(
+    const Err::ShotFileReader& file,
+    long long start, long long count,
+    std::string dtype
+) {
+    auto& header = file.get_header();
+    if(start < 0 || count < 0 || start + count > file.size())
+        throw py::index_error("The shots are out of the range of the shot file.");
+    if(dtype != "int32" && dtype != "uint8")
+        throw py::value_error("dtype should be int32 or uint8.");
+    bool narrow = (dtype == "uint8");
+    auto type = (narrow ? py::dtype::of<uint8_t>() : py::dtype::of<int>());
+    auto data = py::array(type, std::vector<ssize_t>({(ssize_t)count, (ssize_t)(1 + header.rounds), (ssize_t)header.x, (ssize_t)header.y}));
+    auto target = py::array(type, std::vector<ssize_t>({(ssize_t)count, (ssize_t)header.x, (ssize_t)header.y}));
+    void* data_ptr = data.mutable_data();
+    void* target_ptr = target.mutable_data();
+    {
+        // the pages of the file are faulted in here, other Python threads may go on meanwhile
+        py::gil_scoped_release release;
+        if(narrow)
+            unpack_shots(file, start, count, (uint8_t*)data_ptr, (uint8_t*)target_ptr);
+        else
+            unpack_shots(file, start, count, (int*)data_ptr, (int*)target_ptr);
+    }
+    return std::make_pair(data, target);
+}
+
+// hand a buffer over to numpy without a copy
+static py::array to_array(std::vector<uint8_t>&& buffer, std::vector<ssize_t> shape) {
+    auto owner = new std::vector<uint8_t>(std::move(buffer));
+    auto capsule = py::capsule(owner, [](void* p) { delete (std::vector<uint8_t>*)p; });
+    return py::array(py::dtype::of<uint8_t>(), shape, {}, owner->data(), capsule);
+}
+
+static py::array widen(const std::vector<uint8_t>& buffer, std::vector<ssize_t> shape) {
+    auto ret = py::array_t<int>(shape);
+    int* out = ret.mutable_data();
+    {
+        py::gil_scoped_release release;
+        for(size_t n = 0; n < buffer.size(); n++)
+            out[n] = buffer[n];
+    }
+    return ret;
+}
+
+std::pair<py::array, py::array> next_shots(ShotIterator& iterator) {
+    bool more;
+    {
+        // the trainer and the other Python threads go on while the workers fill the ring
+        py::gil_scoped_release release;
+        more = iterator.producer->next(iterator.batch);
+    }
+    if(!more)
+        throw py::stop_iteration();
+    auto shape = iterator.producer->get_shape();
+    auto& batch = iterator.batch;
+    auto shape_data = std::vector<ssize_t>({batch.size, 1 + iterator.producer->get_rounds(), shape.x(), shape.y()});
+    auto shape_target = std::vector<ssize_t>({batch.size, shape.x(), shape.y()});
+    if(iterator.narrow)
+        return std::make_pair(to_array(std::move(batch.data), shape_data), to_array(std::move(batch.target), shape_target));
+    return std::make_pair(widen(batch.data, shape_data), widen(batch.target, shape_target));
+}
+
 PYBIND11_MODULE(deep_decoder_util, m) {
-    m.def("get_logical_error", &get_logical_error);
-    m.def("apply_logical_error", &apply_logical_error);
-    m.def("is_valid", &is_valid);
+    // the exact dtypes first: pybind11 tries the overloads in order, without casting before with
+    m.def("get_logical_error", &get_logical_error<ErrorArray<uint8_t>>);
+    m.def("get_logical_error", &get_logical_error<ErrorArray<int8_t>>);
+    m.def("get_logical_error", &get_logical_error<IntErrorArray>);
+    m.def("apply_logical_error", &apply_logical_error<ErrorArray<uint8_t>>);
+    m.def("apply_logical_error", &apply_logical_error<ErrorArray<int8_t>>);
+    m.def("apply_logical_error", &apply_logical_error<IntErrorArray>);
+    m.def("is_valid", &is_valid<ErrorArray<uint8_t>>);
+    m.def("is_valid", &is_valid<ErrorArray<int8_t>>);
+    m.def("is_valid", &is_valid<IntErrorArray>);
     m.def("qubit_type", &qubit_type);
-    m.def("apply_physical_correction", &apply_physical_correction);
+    m.def("apply_physical_correction", &apply_physical_correction<ErrorArray<uint8_t>>);
+    m.def("apply_physical_correction", &apply_physical_correction<ErrorArray<int8_t>>);
+    m.def("apply_physical_correction", &apply_physical_correction<IntErrorArray>);
+
+    py::class_<Err::ShotFileReader, std::shared_ptr<Err::ShotFileReader>>(m, "ShotFile")
+        .def(py::init<std::string>())
+        .def("__len__", &Err::ShotFileReader::size)
+        .def_property_readonly("x", [](const Err::ShotFileReader& file) { return file.get_header().x; })
+        .def_property_readonly("y", [](const Err::ShotFileReader& file) { return file.get_header().y; })
+        .def_property_readonly("rounds", [](const Err::ShotFileReader& file) { return file.get_header().rounds; })
+        .def_property_readonly("p", [](const Err::ShotFileReader& file) { return file.get_header().p; })
+        .def_property_readonly("noise", [](const Err::ShotFileReader& file) { return file.get_header().noise; })
+        .def_property_readonly("seed", [](const Err::ShotFileReader& file) { return file.get_header().seed; })
+        .def("read", &read_shots, py::arg("start"), py::arg("count"), py::arg("dtype") = "int32");
+
+    py::class_<ShotIterator, std::shared_ptr<ShotIterator>>(m, "ShotProducer")
+        .def(py::init([](int d, double p_x, double p_y, double p_z, double p_m, int rounds, int batch_size,
+                         int threads, int capacity, unsigned long long seed, long long batches, std::string dtype) {
+            if(dtype != "int32" && dtype != "uint8")
+                throw py::value_error("dtype should be int32 or uint8.");
+            auto make_model = [=]() {
+                return std::make_shared<Err::ErrorModel::IIDError>(p_x, p_y, p_z, p_m);
+            };
+            auto ret = std::make_shared<ShotIterator>();
+            ret->producer = std::make_shared<Err::ShotProducer>(d, rounds, batch_size, make_model, seed, threads, capacity, batches);
+            ret->narrow = (dtype == "uint8");
+            return ret;
+        }),
+            py::arg("d"), py::arg("p_x"), py::arg("p_y"), py::arg("p_z"), py::arg("p_m") = 0.0,
+            py::arg("rounds") = 1, py::arg("batch_size") = 1000, py::arg("threads") = 1, py::arg("capacity") = 16,
+            py::arg("seed") = 0, py::arg("batches") = -1, py::arg("dtype") = "int32")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &next_shots)
+        .def("stop", [](ShotIterator& iterator) { iterator.producer->stop(); });
 }
\ No newline at end of file
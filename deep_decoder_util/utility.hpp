@@ -1,5 +1,10 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
+#include "shot_file.hpp"
+#include "shot_producer.hpp"
+#include <memory>
+#include <string>
+#include <utility>
 
 namespace py = pybind11;
 
@@ -10,24 +15,45 @@ static int pauli_mult[4][4] = {
     3, 2, 1, 0,
 };
 
-py::array_t<int> get_logical_error(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors
-);
+/*
+The kernels take the errors, shape (B, X, Y), without a copy as int32, uint8 or int8;
+any other dtype is cast to int32. They run on the buffers of numpy with the GIL
+released and split the batch over the OpenMP threads.
+*/
+using IntErrorArray = py::array_t<int, py::array::forcecast | py::array::c_style>;
+template<typename T>
+using ErrorArray = py::array_t<T, py::array::c_style>;
 
-py::array_t<int> apply_logical_error(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors,
-    py::array_t<int, py::array::forcecast | py::array::c_style> &logical_errors
-);
+// the logical error of every sample, shape (B, )
+template<typename Array>
+py::array_t<int> get_logical_error(Array &physical_errors);
 
-py::array_t<int> is_valid(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors
-);
+template<typename Array>
+Array apply_logical_error(Array &physical_errors, IntErrorArray &logical_errors);
+
+// 1 where the error anticommutes with no stabilizer, shape (B, )
+template<typename Array>
+py::array_t<int> is_valid(Array &physical_errors);
 
 py::array_t<int> qubit_type(
     int x, int y
 );
 
-py::array_t<int> apply_physical_correction(
-    py::array_t<int, py::array::forcecast | py::array::c_style> &physical_errors,
-    py::array_t<int, py::array::forcecast | py::array::c_style> &corrections
-);
\ No newline at end of file
+template<typename Array>
+Array apply_physical_correction(Array &physical_errors, Array &corrections);
+
+// shots [start, start + count) of a shot file as to_pyarray of MLDecoder exports them, dtype "int32" or "uint8"
+std::pair<py::array, py::array> read_shots(
+    const ErrorDynamics::ShotFileReader& file,
+    long long start, long long count,
+    std::string dtype
+);
+
+// a ShotProducer as a Python iterator of (data, target) batches
+struct ShotIterator {
+    std::shared_ptr<ErrorDynamics::ShotProducer> producer;
+    bool narrow;
+    ErrorDynamics::ShotBatch batch;
+};
+
+std::pair<py::array, py::array> next_shots(ShotIterator& iterator);
\ No newline at end of file
@@ -262,4 +262,59 @@ Util::Pauli PlanarError::logical_error() const {
     return logical_err;
 }
 
+PlanarErasure::PlanarErasure(int _x, int _y) {
+    x = _x, y = _y;
+    list = std::vector<int>(x * y, 0);
+}
+
+PlanarErasure::PlanarErasure(int _d) : PlanarErasure::PlanarErasure(_d, _d) {}
+
+PlanarErasure::PlanarErasure(const PlanarErasure& other) {
+    x = other.x;
+    y = other.y;
+    list = other.list;
+}
+
+void PlanarErasure::merge(const PlanarErasure& other) {
+    if(!(get_shape() == other.get_shape()))
+        throw Util::BadShape(std::string("The two erasures should have the same shape."));
+    for(int k = 0; k < x * y; k++)
+        list[k] |= other.list[k];
+}
+
+int PlanarErasure::count() const {
+    int ret = 0;
+    for(int k = 0; k < x * y; k++)
+        ret += list[k];
+    return ret;
+}
+
+std::string PlanarErasure::to_string(bool color, int interval) const {
+    std::string ret = std::string("");
+    for(int i = 0; i < x; i++) {
+        if(i != 0) {
+            std::string v_interval = std::string("");
+            for(int j = 0; j < y; j++) {
+                if(j != 0)
+                    v_interval += std::string(2 * interval + 1, ' ');
+                v_interval += Util::show_interval_v(color, false);
+            }
+            v_interval += '\n';
+            for(int _ = 0; _ < interval; _++)
+                ret += v_interval;
+        }
+        for(int j = 0; j < y; j++) {
+            if(j != 0) {
+                ret += Util::show_interval_h(color, false, interval);
+            }
+            if((i + j) % 2 == 0)
+                ret += (is_erased(PlanarIndex(i, j)) ? (color ? std::string("\033[1;35mE\033[0m") : std::string("E")) : std::string("."));
+            else
+                ret += '*';
+        }
+        ret += '\n';
+    }
+    return ret;
+}
+
 }}
\ No newline at end of file
@@ -39,6 +39,7 @@ class PlanarShape {
 class PlanarScheme;
 class PlanarSyndrome;
 class PlanarError;
+class PlanarErasure;
 
 class PlanarScheme {
     /*
@@ -125,6 +126,8 @@ class PlanarSyndrome {
     inline std::vector<int> to_vector() const {
         return std::vector<int>(list);
     }
+    // the x * y symptoms, row by row, without a copy
+    inline const int* data() const { return list.data(); }
 
     std::string to_string(bool color = false, int interval = 1) const;
 };
@@ -154,6 +157,8 @@ class PlanarError {
     inline std::vector<int> to_vector() const {
         return std::vector<int>(list);
     }
+    // the x * y Paulis, row by row, without a copy
+    inline const int* data() const { return list.data(); }
 
     std::vector<int> count_errors() const;
 
@@ -165,6 +170,36 @@ class PlanarError {
     Util::Pauli logical_error() const;    
 };
 
+class PlanarErasure {
+    // heralded locations: 1 for every data qubit whose error is known to be uniformly random
+    int x, y;
+    std::vector<int> list;
+    public:
+    PlanarErasure() = delete;
+    PlanarErasure(int _x, int _y);
+    PlanarErasure(int _d);
+    PlanarErasure(const PlanarErasure& other);
+
+    inline const PlanarShape get_shape() const {
+        return PlanarShape(x, y);
+    }
+    inline bool is_erased(PlanarIndex index) const {
+        return list[index.i() * y + index.j()] != 0;
+    }
+    inline void set_erased(PlanarIndex index) {
+        list[index.i() * y + index.j()] = 1;
+    }
+    inline std::vector<int> to_vector() const {
+        return std::vector<int>(list);
+    }
+
+    // union with the erasure of another round
+    void merge(const PlanarErasure& other);
+    int count() const;
+
+    std::string to_string(bool color = false, int interval = 1) const;
+};
+
 inline std::shared_ptr<PlanarSyndrome> operator^(std::shared_ptr<PlanarSyndrome> a, std::shared_ptr<PlanarSyndrome> b) {
     if(!(a->get_shape() == b->get_shape()))
         throw Util::BadShape(std::string("The two syndromes should have the same shape."));
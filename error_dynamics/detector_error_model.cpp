@@ -0,0 +1,243 @@
+#include "detector_error_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace ErrorDynamics {
+
+namespace {
+
+using Pauli = Util::Pauli;
+
+struct Gate {
+    int control, target;
+};
+
+// the four CNOT layers of a round, sites indexed by i * y + j
+std::vector<std::vector<Gate>> schedule(int x, int y) {
+    static const int z_order[4][2] = {{-1, 0}, {0, -1}, {0, 1}, {1, 0}};
+    static const int x_order[4][2] = {{-1, 0}, {0, 1}, {0, -1}, {1, 0}};
+    auto ret = std::vector<std::vector<Gate>>(4);
+    for(int i = 0; i < x; i++) {
+        for(int j = (i + 1) % 2; j < y; j += 2) {
+            bool measure_z = i % 2 == 0;
+            for(int k = 0; k < 4; k++) {
+                int ni = i + (measure_z ? z_order : x_order)[k][0], nj = j + (measure_z ? z_order : x_order)[k][1];
+                if(ni < 0 || ni >= x || nj < 0 || nj >= y)
+                    continue;
+                int data = ni * y + nj, measure = i * y + j;
+                ret[k].push_back(measure_z ? Gate{data, measure} : Gate{measure, data});
+            }
+        }
+    }
+    return ret;
+}
+
+// X spreads from the control to the target, Z from the target to the control
+void propagate(std::vector<Pauli>& frame, const std::vector<std::vector<Gate>>& layers, int from) {
+    for(int k = from; k < (int)layers.size(); k++) {
+        for(auto& gate: layers[k]) {
+            bool spread_x = Util::is_xy(frame[gate.control]), spread_z = Util::is_zy(frame[gate.target]);
+            if(spread_x)
+                frame[gate.target] = frame[gate.target] * Pauli::X;
+            if(spread_z)
+                frame[gate.control] = frame[gate.control] * Pauli::Z;
+        }
+    }
+}
+
+// the rate of each of the 4^n - 1 independent Paulis on n qubits that together make a depolarizing channel of rate p
+double independent_rate(double p, int n) {
+    double paulis = std::pow(4.0, n);
+    return (1 - std::pow(1 - p * paulis / (paulis - 1), 2 / paulis)) / 2;
+}
+
+using Key = std::pair<std::vector<int>, std::vector<std::pair<int, Pauli>>>;
+
+// independent mechanisms of the same effect: one of them, but not both
+void merge(std::map<Key, double>& merged, const Key& key, double p) {
+    auto& q = merged[key];
+    q = q * (1 - p) + p * (1 - q);
+}
+
+}
+
+DetectorErrorModel::DetectorErrorModel(const CodeScheme::PlanarShape shape, int _rounds, CircuitNoise noise)
+    : x(shape.x()), y(shape.y()), rounds(_rounds) {
+    if(rounds <= 0)
+        throw Util::BadShape(std::string("A detector error model needs at least one round."));
+    if(noise.p_gate < 0 || noise.p_gate > 15.0 / 16 || noise.p_idle < 0 || noise.p_idle > 3.0 / 4
+        || noise.p_reset < 0 || noise.p_reset > 1 || noise.p_measure < 0 || noise.p_measure > 1)
+        throw Util::BadType(std::string("The rates of a circuit noise should be probabilities, at most those of a full depolarization."));
+    int plane = x * y;
+    auto layers = schedule(x, y);
+    auto is_data = [&](int site) { return ((site / y) + (site % y)) % 2 == 0; };
+    auto is_measure_z = [&](int site) { return !is_data(site) && (site / y) % 2 == 0; };
+
+    // the effect of a fault of a round: the measurements of the round it flips, then the syndrome of the data error it leaves
+    auto per_round = std::map<Key, double>();
+    auto add_fault = [&](std::vector<Pauli>& frame, int from, double p, int flipped_measure) {
+        if(p <= 0)
+            return;
+        propagate(frame, layers, from);
+        auto measured = std::vector<int>(plane, 0);
+        auto key = Key();
+        for(int site = 0; site < plane; site++) {
+            if(is_data(site)) {
+                if(frame[site] != Pauli::I)
+                    key.second.push_back(std::make_pair(site, frame[site]));
+                continue;
+            }
+            measured[site] = (is_measure_z(site) ? Util::is_xy(frame[site]) : Util::is_zy(frame[site])) ^ (site == flipped_measure);
+        }
+        auto error = CodeScheme::PlanarScheme(x, y);
+        for(auto& flip: key.second)
+            error.add_data_error(CodeScheme::PlanarIndex(flip.first / y, flip.first % y), flip.second);
+        auto syndrome = error.get_syndrome();
+        for(int site = 0; site < plane; site++) {
+            if(measured[site])
+                key.first.push_back(site);
+        }
+        for(int site = 0; site < plane; site++) {
+            if(!is_data(site) && (measured[site] ^ (syndrome->get_symptom(CodeScheme::PlanarIndex(site / y, site % y)) == Util::Symptom::NEGATIVE)))
+                key.first.push_back(plane + site);
+        }
+        merge(per_round, key, p);
+    };
+
+    auto frame = std::vector<Pauli>(plane, Pauli::I);
+    auto clear = [&]() { std::fill(frame.begin(), frame.end(), Pauli::I); };
+    for(int site = 0; site < plane; site++) {
+        if(is_data(site)) {
+            for(auto pauli: {Pauli::X, Pauli::Y, Pauli::Z}) {
+                clear();
+                frame[site] = pauli;
+                add_fault(frame, 0, independent_rate(noise.p_idle, 1), -1);
+            }
+        }
+        else {
+            clear();
+            frame[site] = (is_measure_z(site) ? Pauli::X : Pauli::Z);
+            add_fault(frame, 0, noise.p_reset, -1);
+            clear();
+            add_fault(frame, 4, noise.p_measure, site);
+        }
+    }
+    for(int k = 0; k < 4; k++) {
+        for(auto& gate: layers[k]) {
+            for(int pauli = 1; pauli < 16; pauli++) {
+                clear();
+                frame[gate.control] = (Pauli)(pauli / 4);
+                frame[gate.target] = (Pauli)(pauli % 4);
+                add_fault(frame, k + 1, independent_rate(noise.p_gate, 2), -1);
+            }
+        }
+    }
+
+    auto logical = [&](const std::vector<std::pair<int, Pauli>>& data) {
+        auto error = CodeScheme::PlanarError(x, y);
+        for(auto& flip: data)
+            error.mult_error(CodeScheme::PlanarIndex(flip.first / y, flip.first % y), flip.second);
+        return error.logical_error();
+    };
+    for(auto& mechanism: per_round) {
+        if(mechanism.second > 0)
+            round_mechanisms.push_back(Mechanism{mechanism.second, mechanism.first.first, mechanism.first.second, logical(mechanism.first.second)});
+    }
+
+    // every round the same, the detectors past the last round are never measured
+    auto merged = std::map<Key, double>();
+    for(int t = 0; t < rounds; t++) {
+        for(auto& mechanism: round_mechanisms) {
+            auto key = Key(std::vector<int>(), mechanism.frame);
+            for(int detector: mechanism.detectors) {
+                if(t * plane + detector < rounds * plane)
+                    key.first.push_back(t * plane + detector);
+            }
+            merge(merged, key, mechanism.p);
+        }
+    }
+    auto rate = std::vector<double>();
+    for(auto& mechanism: merged) {
+        auto pauli = logical(mechanism.first.second);
+        // a stabilizer that flips no detector changes nothing
+        if(mechanism.first.first.empty() && pauli == Pauli::I)
+            continue;
+        mechanisms.push_back(Mechanism{mechanism.second, mechanism.first.first, mechanism.first.second, pauli});
+        rate.push_back(mechanism.second);
+    }
+    sampler = Util::SparseSampler(rate);
+}
+
+PlanarData DetectorErrorModel::sample(std::mt19937& engine) const {
+    int plane = x * y;
+    auto syndromes = std::make_shared<std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>>(0);
+    for(int t = 0; t < rounds; t++)
+        syndromes->push_back(std::make_shared<CodeScheme::PlanarSyndrome>(x, y));
+    auto error = std::make_shared<CodeScheme::PlanarError>(x, y);
+    sampler.sample(engine, 1.0, [&](int k) {
+        auto& mechanism = mechanisms[k];
+        for(int detector: mechanism.detectors)
+            (*syndromes)[detector / plane]->change_symptom(CodeScheme::PlanarIndex((detector % plane) / y, detector % y));
+        for(auto& flip: mechanism.frame)
+            error->mult_error(CodeScheme::PlanarIndex(flip.first / y, flip.first % y), flip.second);
+    });
+    return std::make_pair(syndromes, error);
+}
+
+namespace {
+
+/*
+The rates of the edges of the lattice of a check type, from the mechanisms of a round:
+of the data qubits, and of the measurements of the checks. measure_z picks the measure-Z
+checks, on the even rows, which see the X-type flips.
+*/
+std::pair<std::vector<double>, std::vector<double>> edge_rate(
+    const std::vector<DetectorErrorModel::Mechanism>& mechanisms, int x, int y, bool measure_z
+) {
+    int plane = x * y;
+    auto ret = std::make_pair(std::vector<double>(plane, 0), std::vector<double>(plane, 0));
+    auto combine = [](double& rate, double p) { rate = rate * (1 - p) + p * (1 - rate); };
+    for(auto& mechanism: mechanisms) {
+        auto detectors = std::vector<int>();
+        for(int detector: mechanism.detectors) {
+            if(((detector % plane) / y) % 2 == (measure_z ? 0 : 1))
+                detectors.push_back(detector);
+        }
+        auto flips = std::vector<int>();
+        for(auto& flip: mechanism.frame) {
+            if(measure_z ? Util::is_xy(flip.second) : Util::is_zy(flip.second))
+                flips.push_back(flip.first);
+        }
+        if(detectors.empty())
+            continue;
+        if(flips.size() == 1)
+            combine(ret.first[flips[0]], mechanism.p);
+        // a time-like edge: the same check in this round and the next
+        else if(flips.empty() && detectors.size() == 2 && detectors[1] == detectors[0] + plane)
+            combine(ret.second[detectors[0]], mechanism.p);
+    }
+    return ret;
+}
+
+}
+
+std::vector<double> DetectorErrorModel::x_flip_weight() const {
+    return Util::matching_weight(edge_rate(round_mechanisms, x, y, true).first);
+}
+
+std::vector<double> DetectorErrorModel::z_flip_weight() const {
+    return Util::matching_weight(edge_rate(round_mechanisms, x, y, false).first);
+}
+
+std::vector<double> DetectorErrorModel::measure_weight() const {
+    // the two types of checks are on different sites
+    auto rate = edge_rate(round_mechanisms, x, y, true).second;
+    auto x_rate = edge_rate(round_mechanisms, x, y, false).second;
+    for(int n = 0; n < (int)rate.size(); n++)
+        rate[n] += x_rate[n];
+    return Util::matching_weight(rate);
+}
+
+}
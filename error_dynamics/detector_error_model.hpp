@@ -0,0 +1,79 @@
+#pragma once
+
+#include "planar_surface_code.hpp"
+
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace ErrorDynamics {
+
+struct CircuitNoise {
+    /*
+    The fault rates of the syndrome extraction circuit, each per location:
+        p_gate      a two-qubit Pauli after every CNOT, the 15 of them p_gate / 15 each
+        p_reset     a measure qubit prepared in the flipped state
+        p_measure   a measurement outcome flipped
+        p_idle      X, Y, Z with p_idle / 3 each on every data qubit at the start of a round
+    The depolarizing channels are compiled into independent Paulis of the same marginals.
+    */
+    double p_gate, p_reset, p_measure, p_idle;
+
+    inline CircuitNoise(double p) : p_gate(p), p_reset(p), p_measure(p), p_idle(p) {}
+    inline CircuitNoise(double _p_gate, double _p_reset, double _p_measure, double _p_idle)
+        : p_gate(_p_gate), p_reset(_p_reset), p_measure(_p_measure), p_idle(_p_idle) {}
+};
+
+class DetectorErrorModel {
+    /*
+    The circuit noise of rounds rounds of syndrome extraction on a PlanarScheme, compiled
+    once into independent fault mechanisms. Every round, the measure-Z qubits are targets
+    of CNOTs from their data qubits in the order N, W, E, S, and the measure-X qubits
+    control CNOTs onto theirs in the order N, E, W, S. Every fault location of a round is
+    propagated as a Pauli frame through the rest of the round, which gives the measurements
+    it flips and the data error it leaves; the identical mechanisms are merged.
+
+    A shot flips the detectors and the data of the mechanisms drawn by a Util::SparseSampler,
+    so it costs O(faults) and simulates no gate. The detectors are the syndrome changes of
+    PlanarSurfaceCode::get_data, indexed by t * x * y + i * y + j, and the error is the data
+    error after the last round, so the shots decode as those of the phenomenological models.
+    */
+    public:
+    struct Mechanism {
+        double p;
+        std::vector<int> detectors;
+        // the data error it leaves, (i * y + j, Pauli)
+        std::vector<std::pair<int, Util::Pauli>> frame;
+        Util::Pauli logical;
+    };
+
+    private:
+    int x, y, rounds;
+    std::vector<Mechanism> mechanisms;
+    // the mechanisms of a round in the bulk, with the detectors of that round and the next
+    std::vector<Mechanism> round_mechanisms;
+    Util::SparseSampler sampler;
+
+    public:
+    DetectorErrorModel() = delete;
+    DetectorErrorModel(const CodeScheme::PlanarShape shape, int _rounds, CircuitNoise noise);
+
+    PlanarData sample(std::mt19937& engine) const;
+
+    inline const std::vector<Mechanism>& get_mechanisms() const { return mechanisms; }
+    inline const CodeScheme::PlanarShape get_shape() const { return CodeScheme::PlanarShape(x, y); }
+    inline int get_rounds() const { return rounds; }
+
+    /*
+    The matching weights -log p of WeightedMWPMDecoder, indexed by i * y + j, from the
+    mechanisms of a round: a mechanism whose frame flips a single data qubit on the lattice
+    of a check type adds to the weight of that qubit, one that flips none adds to the
+    measurement weight of its check. The hook mechanisms, on two or more data qubits, have
+    no edge of their own there and are left out.
+    */
+    std::vector<double> x_flip_weight() const;
+    std::vector<double> z_flip_weight() const;
+    std::vector<double> measure_weight() const;
+};
+
+}
@@ -4,4 +4,7 @@
 #include "code_scheme.hpp"
 #include "error_model.hpp"
 
-#include "planar_surface_code.hpp"
\ No newline at end of file
+#include "planar_surface_code.hpp"
+#include "detector_error_model.hpp"
+#include "shot_file.hpp"
+#include "shot_producer.hpp"
\ No newline at end of file
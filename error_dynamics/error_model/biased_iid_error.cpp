@@ -0,0 +1,44 @@
+#include "biased_iid_error.hpp"
+
+#include <cmath>
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+BiasedIIDError::BiasedIIDError(double _px, double _py, double _pz, double _pm, double _scale) {
+    px = _px, py = _py, pz = _pz, pm = _pm;
+    scale = _scale;
+    if((px + py + pz) * scale > 1 || pm * scale > 1)
+        throw Util::BadType(std::string("The biased error probabilities should not exceed 1."));
+    log_weight = 0;
+}
+
+std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> BiasedIIDError::generate_planar_error(CodeScheme::PlanarShape shape) {
+    double p_data = px + py + pz;
+    std::discrete_distribution<> data_distribution({1 - scale * p_data, scale * px, scale * py, scale * pz});
+    std::discrete_distribution<> measure_distribution({1 - scale * pm, scale * pm});
+    // log P / Q of a site with and without an error
+    double log_error = -std::log(scale);
+    double log_data_clean = std::log((1 - p_data) / (1 - scale * p_data));
+    double log_measure_clean = std::log((1 - pm) / (1 - scale * pm));
+
+    auto ret = std::make_pair(std::make_shared<CodeScheme::PlanarError>(shape.x(), shape.y()), std::make_shared<CodeScheme::PlanarSyndrome>(shape.x(), shape.y()));
+
+    for(int i = 0; i < shape.x(); i++) {
+        for(int j = 0; j < shape.y(); j++) {
+            if((i + j) % 2 == 0) {
+                int pauli = data_distribution(rng_engine);
+                ret.first->mult_error(CodeScheme::PlanarIndex(i, j), (Util::Pauli)pauli);
+                log_weight += (pauli != 0 ? log_error : log_data_clean);
+            } else if(pm > 0) {
+                int symptom = measure_distribution(rng_engine);
+                ret.second->change_symptom(CodeScheme::PlanarIndex(i, j), (Util::Symptom)symptom);
+                log_weight += (symptom != 0 ? log_error : log_measure_clean);
+            }
+        }
+    }
+
+    return ret;
+}
+
+}}
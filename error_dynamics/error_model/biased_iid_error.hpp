@@ -0,0 +1,30 @@
+#pragma once
+#include "error_model_base.hpp"
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+class BiasedIIDError: public ErrorModelBase{
+    /*
+    Importance sampling of IIDError(px, py, pz, pm): the errors are drawn with
+    every probability multiplied by scale, and the log-likelihood ratio
+    log P(E) / Q(E) of everything drawn since the last reset_log_weight() is
+    kept, so that a failure can be reweighted by exp(log_weight()).
+    */
+    private:
+    double px, py, pz;
+    double pm;
+    double scale;
+    double log_weight;
+
+    public:
+    BiasedIIDError() = delete;
+    BiasedIIDError(double _px, double _py, double _pz, double _pm, double _scale);
+
+    std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> generate_planar_error(const CodeScheme::PlanarShape shape);
+
+    inline double get_log_weight() const { return log_weight; }
+    inline void reset_log_weight() { log_weight = 0; }
+};
+
+}}
@@ -0,0 +1,38 @@
+#include "erasure_error.hpp"
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+ErasureError::ErasureError(double _pe, double _px, double _py, double _pz, double _pm) {
+    pe = _pe, px = _px, py = _py, pz = _pz, pm = _pm;
+}
+
+std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> ErasureError::generate_planar_error(CodeScheme::PlanarShape shape) {
+    std::bernoulli_distribution erasure_distribution(pe);
+    std::uniform_int_distribution<> erased_distribution(0, 3);
+    std::discrete_distribution<> data_distribution({1-px-py-pz, px, py, pz});
+    std::discrete_distribution<> measure_distribution({1-pm, pm});
+
+    auto ret = std::make_pair(std::make_shared<CodeScheme::PlanarError>(shape.x(), shape.y()), std::make_shared<CodeScheme::PlanarSyndrome>(shape.x(), shape.y()));
+    erasure = std::make_shared<CodeScheme::PlanarErasure>(shape.x(), shape.y());
+
+    for(int i = 0; i < shape.x(); i++) {
+        for(int j = 0; j < shape.y(); j++) {
+            auto index = CodeScheme::PlanarIndex(i, j);
+            if((i + j) % 2 == 0) {
+                if(erasure_distribution(rng_engine)) {
+                    erasure->set_erased(index);
+                    ret.first->mult_error(index, (Util::Pauli)erased_distribution(rng_engine));
+                } else {
+                    ret.first->mult_error(index, (Util::Pauli)data_distribution(rng_engine));
+                }
+            } else {
+                ret.second->change_symptom(index, (Util::Symptom)measure_distribution(rng_engine));
+            }
+        }
+    }
+
+    return ret;
+}
+
+}}
@@ -0,0 +1,29 @@
+#pragma once
+#include "error_model_base.hpp"
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+class ErasureError: public ErrorModelBase{
+    /*
+    Every data qubit is erased with probability pe. An erased qubit is replaced
+    by a maximally mixed state, i.e. it suffers I, X, Y or Z with probability 1/4
+    each, and its location is heralded. On top of that, the qubits suffer the
+    same i.i.d. Pauli and measurement errors as IIDError.
+    */
+    private:
+    double pe;
+    double px, py, pz;
+    double pm;
+    std::shared_ptr<CodeScheme::PlanarErasure> erasure;
+
+    public:
+    ErasureError() = delete;
+    ErasureError(double _pe, double _px, double _py, double _pz, double _pm);
+    inline ErasureError(double _pe) : ErasureError(_pe, 0, 0, 0, 0) {}
+
+    std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> generate_planar_error(const CodeScheme::PlanarShape shape);
+    inline std::shared_ptr<CodeScheme::PlanarErasure> last_erasure() const { return erasure; }
+};
+
+}}
@@ -1,4 +1,8 @@
 #pragma once
 
 #include "error_model_base.hpp"
-#include "iid_error.hpp"
\ No newline at end of file
+#include "iid_error.hpp"
+#include "erasure_error.hpp"
+#include "biased_iid_error.hpp"
+#include "fixed_weight_error.hpp"
+#include "heterogeneous_error.hpp"
\ No newline at end of file
@@ -3,16 +3,32 @@
 #include "code_scheme.hpp"
 
 #include <memory>
+#include <random>
 #include <utility>
 
 namespace ErrorDynamics {
 namespace ErrorModel {
 
 class ErrorModelBase {
+    protected:
+    std::mt19937 rng_engine;
+
     public:
-    ErrorModelBase(){}
+    inline ErrorModelBase() {
+        std::random_device random_device{};
+        rng_engine = std::mt19937(random_device());
+    }
+
+    // restart the random stream, for reproducible runs
+    inline void seed(unsigned long long s) {
+        std::seed_seq seq({(unsigned int)s, (unsigned int)(s >> 32)});
+        rng_engine.seed(seq);
+    }
     
     virtual std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> generate_planar_error(const CodeScheme::PlanarShape shape) = 0;
+
+    // the heralded locations of the last generated error, nullptr for models without erasure
+    virtual std::shared_ptr<CodeScheme::PlanarErasure> last_erasure() const { return nullptr; }
 };
 
 }};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "fixed_weight_error.hpp"
+
+#include <vector>
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+FixedWeightError::FixedWeightError(int _k, double _px, double _py, double _pz) {
+    k = _k;
+    px = _px, py = _py, pz = _pz;
+}
+
+std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> FixedWeightError::generate_planar_error(CodeScheme::PlanarShape shape) {
+    std::discrete_distribution<> pauli_distribution({px, py, pz});
+
+    auto ret = std::make_pair(std::make_shared<CodeScheme::PlanarError>(shape.x(), shape.y()), std::make_shared<CodeScheme::PlanarSyndrome>(shape.x(), shape.y()));
+
+    auto sites = std::vector<CodeScheme::PlanarIndex>();
+    for(int i = 0; i < shape.x(); i++) {
+        for(int j = i % 2; j < shape.y(); j += 2)
+            sites.push_back(CodeScheme::PlanarIndex(i, j));
+    }
+    if(k < 0 || k > (int)sites.size())
+        throw Util::BadType(std::string("The number of faults should be between 0 and the number of data qubits."));
+
+    // partial Fisher-Yates: the first k sites are a uniform k-subset
+    for(int n = 0; n < k; n++) {
+        std::uniform_int_distribution<int> site_distribution(n, (int)sites.size() - 1);
+        std::swap(sites[n], sites[site_distribution(rng_engine)]);
+        ret.first->mult_error(sites[n], (Util::Pauli)(pauli_distribution(rng_engine) + 1));
+    }
+
+    return ret;
+}
+
+}}
@@ -0,0 +1,28 @@
+#pragma once
+#include "error_model_base.hpp"
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+class FixedWeightError: public ErrorModelBase{
+    /*
+    Exactly k data qubits, chosen uniformly, suffer X, Y or Z with probabilities
+    proportional to px, py and pz; there is no measurement error. Conditioned on
+    its number of faults, IIDError(px, py, pz, 0) is this model.
+    */
+    private:
+    int k;
+    double px, py, pz;
+
+    public:
+    FixedWeightError() = delete;
+    FixedWeightError(int _k, double _px, double _py, double _pz);
+    inline FixedWeightError(int _k) : FixedWeightError(_k, 1, 1, 1) {}
+
+    std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> generate_planar_error(const CodeScheme::PlanarShape shape);
+
+    inline int get_weight() const { return k; }
+    inline void set_weight(int _k) { k = _k; }
+};
+
+}}
@@ -0,0 +1,156 @@
+#include "heterogeneous_error.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+RateMap::RateMap(int _x, int _y) : x(_x), y(_y) {
+    px = std::vector<double>(x * y, 0);
+    py = std::vector<double>(x * y, 0);
+    pz = std::vector<double>(x * y, 0);
+    pm = std::vector<double>(x * y, 0);
+}
+
+RateMap RateMap::uniform(int _x, int _y, double _px, double _py, double _pz, double _pm) {
+    auto ret = RateMap(_x, _y);
+    for(int i = 0; i < _x; i++) {
+        for(int j = 0; j < _y; j++) {
+            int n = i * _y + j;
+            if((i + j) % 2 == 0)
+                ret.px[n] = _px, ret.py[n] = _py, ret.pz[n] = _pz;
+            else
+                ret.pm[n] = _pm;
+        }
+    }
+    return ret;
+}
+
+RateMap RateMap::load(std::string path) {
+    std::ifstream file(path);
+    int _x, _y;
+    if(!(file >> _x >> _y) || _x <= 0 || _y <= 0)
+        throw Util::BadFile(path + ": not a rate map");
+    auto ret = RateMap(_x, _y);
+    for(auto rates: {&ret.px, &ret.py, &ret.pz, &ret.pm}) {
+        for(auto& rate: *rates) {
+            if(!(file >> rate))
+                throw Util::BadFile(path + ": the rate map should have " + std::to_string(4 * _x * _y) + " rates");
+        }
+    }
+    return ret;
+}
+
+HeterogeneousError::HeterogeneousError(const RateMap& map) : scale(1) {
+    set_rates(map);
+}
+
+HeterogeneousError::HeterogeneousError(const std::vector<RateMap>& maps) : scale(1) {
+    for(auto& map: maps)
+        set_rates(map);
+}
+
+void HeterogeneousError::set_rates(const RateMap& map) {
+    int size = map.x * map.y;
+    if((int)map.px.size() != size || (int)map.py.size() != size || (int)map.pz.size() != size || (int)map.pm.size() != size)
+        throw Util::BadShape(std::string("A rate map should have one rate of each kind per site."));
+    auto ret = Table();
+    ret.px = map.px, ret.py = map.py, ret.pz = map.pz, ret.pm = map.pm;
+    ret.alias_probability = std::vector<std::array<double, 3>>(size, {1, 1, 1});
+    ret.alias = std::vector<std::array<int, 3>>(size, {0, 1, 2});
+    ret.max_rate = 0;
+    auto data_rate = std::vector<double>(size, 0), measure_rate = std::vector<double>(size, 0);
+    for(int i = 0; i < map.x; i++) {
+        for(int j = 0; j < map.y; j++) {
+            int n = i * map.y + j;
+            double rate = ((i + j) % 2 == 0 ? map.px[n] + map.py[n] + map.pz[n] : map.pm[n]);
+            if(map.px[n] < 0 || map.py[n] < 0 || map.pz[n] < 0 || map.pm[n] < 0 || rate > 1)
+                throw Util::BadType(std::string("The rates of a site should be probabilities."));
+            ret.max_rate = std::max(ret.max_rate, rate);
+            ((i + j) % 2 == 0 ? data_rate : measure_rate)[n] = rate;
+            if((i + j) % 2 != 0 || rate == 0)
+                continue;
+
+            // Walker's alias table of X, Y and Z given a fault
+            double weight[3] = {map.px[n] * 3 / rate, map.py[n] * 3 / rate, map.pz[n] * 3 / rate};
+            int small[3], large[3], n_small = 0, n_large = 0;
+            for(int k = 0; k < 3; k++)
+                (weight[k] < 1 ? small[n_small++] : large[n_large++]) = k;
+            while(n_small > 0 && n_large > 0) {
+                int s = small[--n_small], l = large[--n_large];
+                ret.alias_probability[n][s] = weight[s];
+                ret.alias[n][s] = l;
+                weight[l] -= 1 - weight[s];
+                (weight[l] < 1 ? small[n_small++] : large[n_large++]) = l;
+            }
+        }
+    }
+    ret.data_sampler = Util::SparseSampler(data_rate);
+    ret.measure_sampler = Util::SparseSampler(measure_rate);
+    if(scale * ret.max_rate > 1)
+        throw Util::BadType(std::string("The scaled rates should be probabilities."));
+    tables[std::make_pair(map.x, map.y)] = ret;
+}
+
+void HeterogeneousError::set_scale(double _scale) {
+    for(auto& shape_table: tables) {
+        if(_scale < 0 || _scale * shape_table.second.max_rate > 1)
+            throw Util::BadType(std::string("The scaled rates should be probabilities."));
+    }
+    scale = _scale;
+}
+
+const HeterogeneousError::Table& HeterogeneousError::table(const CodeScheme::PlanarShape shape) const {
+    auto found = tables.find(std::make_pair(shape.x(), shape.y()));
+    if(found == tables.end())
+        throw Util::BadShape(std::string("No rate map of shape ") + std::to_string(shape.x()) + " x " + std::to_string(shape.y()));
+    return found->second;
+}
+
+std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> HeterogeneousError::generate_planar_error(CodeScheme::PlanarShape shape) {
+    auto& t = table(shape);
+    int y = shape.y();
+    auto ret = std::make_pair(std::make_shared<CodeScheme::PlanarError>(shape.x(), shape.y()), std::make_shared<CodeScheme::PlanarSyndrome>(shape.x(), shape.y()));
+
+    std::uniform_int_distribution<int> column(0, 2);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    t.data_sampler.sample(rng_engine, scale, [&](int site) {
+        int k = column(rng_engine);
+        if(uniform(rng_engine) >= t.alias_probability[site][k])
+            k = t.alias[site][k];
+        ret.first->mult_error(CodeScheme::PlanarIndex(site / y, site % y), (Util::Pauli)(k + 1));
+    });
+    t.measure_sampler.sample(rng_engine, scale, [&](int site) {
+        ret.second->change_symptom(CodeScheme::PlanarIndex(site / y, site % y));
+    });
+    return ret;
+}
+
+std::vector<double> HeterogeneousError::x_flip_weight(const CodeScheme::PlanarShape shape) const {
+    auto& t = table(shape);
+    auto rate = std::vector<double>(t.px.size());
+    for(int n = 0; n < (int)rate.size(); n++)
+        rate[n] = (t.px[n] + t.py[n]) * scale;
+    return Util::matching_weight(rate);
+}
+
+std::vector<double> HeterogeneousError::z_flip_weight(const CodeScheme::PlanarShape shape) const {
+    auto& t = table(shape);
+    auto rate = std::vector<double>(t.px.size());
+    for(int n = 0; n < (int)rate.size(); n++)
+        rate[n] = (t.pz[n] + t.py[n]) * scale;
+    return Util::matching_weight(rate);
+}
+
+std::vector<double> HeterogeneousError::measure_weight(const CodeScheme::PlanarShape shape) const {
+    auto& t = table(shape);
+    auto rate = std::vector<double>(t.pm.size());
+    for(int n = 0; n < (int)rate.size(); n++)
+        rate[n] = t.pm[n] * scale;
+    return Util::matching_weight(rate);
+}
+
+}}
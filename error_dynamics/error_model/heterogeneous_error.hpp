@@ -0,0 +1,73 @@
+#pragma once
+#include "error_model_base.hpp"
+
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ErrorDynamics {
+namespace ErrorModel {
+
+struct RateMap {
+    /*
+    The calibrated error rates of one shape, indexed by i * y + j: px, py and pz on the
+    data qubits, pm on the measure qubits, and zero on the other sites.
+    */
+    int x, y;
+    std::vector<double> px, py, pz, pm;
+
+    RateMap() = delete;
+    RateMap(int _x, int _y);
+    // px, py, pz and pm on every qubit of its type, the rates of IIDError
+    static RateMap uniform(int _x, int _y, double _px, double _py, double _pz, double _pm);
+    // a text file: x y, then x rows of y values for each of px, py, pz and pm in turn
+    static RateMap load(std::string path);
+};
+
+class HeterogeneousError: public ErrorModelBase{
+    /*
+    Every qubit with its own rates, taken from a RateMap per shape. The tables of a shape
+    are built once: the faulty qubits of a shot are drawn by a Util::SparseSampler, so a
+    shot costs O(faults) instead of a draw per qubit, and the Pauli of a faulty data qubit
+    is drawn from its Walker alias table.
+
+    scale multiplies every rate without rebuilding anything, for a slow drift; set_rates
+    replaces the map of a shape for a recalibration.
+    */
+    private:
+    struct Table {
+        std::vector<double> px, py, pz, pm;
+        // of px + py + pz on the data qubits and of pm on the measure qubits
+        Util::SparseSampler data_sampler, measure_sampler;
+        std::vector<std::array<double, 3>> alias_probability;
+        std::vector<std::array<int, 3>> alias;
+        double max_rate;
+    };
+    std::map<std::pair<int, int>, Table> tables;
+    double scale;
+
+    const Table& table(const CodeScheme::PlanarShape shape) const;
+
+    public:
+    HeterogeneousError() = delete;
+    HeterogeneousError(const RateMap& map);
+    HeterogeneousError(const std::vector<RateMap>& maps);
+
+    void set_rates(const RateMap& map);
+    void set_scale(double _scale);
+    inline double get_scale() const { return scale; }
+
+    std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> generate_planar_error(const CodeScheme::PlanarShape shape);
+
+    /*
+    The matching weights -log p of the current rates, indexed by i * y + j: of the X-type
+    flips (X or Y, seen by the measure-Z checks), of the Z-type flips (Z or Y, seen by the
+    measure-X checks), and of the measurement errors, as WeightedMWPMDecoder takes them.
+    */
+    std::vector<double> x_flip_weight(const CodeScheme::PlanarShape shape) const;
+    std::vector<double> z_flip_weight(const CodeScheme::PlanarShape shape) const;
+    std::vector<double> measure_weight(const CodeScheme::PlanarShape shape) const;
+};
+
+}}
@@ -6,8 +6,6 @@ namespace ErrorDynamics {
 namespace ErrorModel {
 
 std::pair<std::shared_ptr<CodeScheme::PlanarError>, std::shared_ptr<CodeScheme::PlanarSyndrome>> IIDError::generate_planar_error(CodeScheme::PlanarShape shape) {
-    std::random_device random_device{};
-    std::mt19937 rng_engine(random_device());
     std::discrete_distribution<> data_distribution({1-px-py-pz, px, py, pz});
     std::discrete_distribution<> measure_distribution({1-pm, pm});
 
@@ -1,4 +1,5 @@
 #include "planar_surface_code.hpp"
+#include "instrument.hpp"
 
 namespace ErrorDynamics {
 
@@ -8,6 +9,7 @@ PlanarSurfaceCode::PlanarSurfaceCode(int _x, int _y, std::shared_ptr<ErrorModel:
     scheme = std::make_shared<CodeScheme::PlanarScheme>(x, y);
     model = _model;
     last_syndrome = std::make_shared<CodeScheme::PlanarSyndrome>(x, y);
+    erasure = std::make_shared<CodeScheme::PlanarErasure>(x, y);
     syndrome_change_list = std::make_shared<std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>>();
 }
 
@@ -21,14 +23,20 @@ void PlanarSurfaceCode::reset() {
     t = 0;
     scheme = std::make_shared<CodeScheme::PlanarScheme>(x, y);
     last_syndrome = std::make_shared<CodeScheme::PlanarSyndrome>(x, y);
+    erasure = std::make_shared<CodeScheme::PlanarErasure>(x, y);
     syndrome_change_list = std::make_shared<std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>>();
 }
 
 void PlanarSurfaceCode::step(int dt) {
+    INSTRUMENT_TIME(STEP);
+    INSTRUMENT_COUNT(STEPS, dt);
     for(int _ = 0; _ < dt; _++) {
         auto errors = model->generate_planar_error(scheme->get_shape());
         scheme->add_data_error(errors.first);
         scheme->add_syndrome_error(errors.second);
+        auto new_erasure = model->last_erasure();
+        if(new_erasure)
+            erasure->merge(*new_erasure);
         last_error = scheme->data_error;
         syndrome_change_list->push_back(scheme->get_syndrome()^last_syndrome);
         last_syndrome = scheme->get_syndrome();
@@ -47,4 +55,9 @@ void PlanarSurfaceCode::manual_step(std::shared_ptr<CodeScheme::PlanarError> dat
     t++;
 }
 
+void PlanarSurfaceCode::manual_step(std::shared_ptr<CodeScheme::PlanarError> data_error, std::shared_ptr<CodeScheme::PlanarSyndrome> syndrome_error, std::shared_ptr<CodeScheme::PlanarErasure> _erasure) {
+    erasure->merge(*_erasure);
+    manual_step(data_error, syndrome_error);
+}
+
 }
\ No newline at end of file
@@ -15,6 +15,7 @@ class PlanarSurfaceCode {
     std::shared_ptr<ErrorModel::ErrorModelBase> model;
     std::shared_ptr<CodeScheme::PlanarSyndrome> last_syndrome;
     std::shared_ptr<CodeScheme::PlanarError> last_error;
+    std::shared_ptr<CodeScheme::PlanarErasure> erasure;
     std::shared_ptr<std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>> syndrome_change_list;
 
     public:
@@ -27,6 +28,7 @@ class PlanarSurfaceCode {
     void reset();
     void step(int dt = 1);
     void manual_step(std::shared_ptr<CodeScheme::PlanarError> data_error, std::shared_ptr<CodeScheme::PlanarSyndrome> syndrome_error);
+    void manual_step(std::shared_ptr<CodeScheme::PlanarError> data_error, std::shared_ptr<CodeScheme::PlanarSyndrome> syndrome_error, std::shared_ptr<CodeScheme::PlanarErasure> _erasure);
     inline void apply_correction(std::shared_ptr<CodeScheme::PlanarError> correction) {
         scheme->add_data_error(correction);
     }
@@ -44,6 +46,19 @@ class PlanarSurfaceCode {
         return std::make_pair(syndrome_list, make_shared<CodeScheme::PlanarError>(*last_error));
     }
 
+    // what get_data copies, as views valid until the next step or reset
+    inline const std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>& view_syndrome_changes() const {
+        return *syndrome_change_list;
+    }
+    inline const CodeScheme::PlanarError& view_last_error() const {
+        return *last_error;
+    }
+
+    // the union of the heralded locations since the last reset
+    inline std::shared_ptr<CodeScheme::PlanarErasure> get_erasure() const {
+        return std::make_shared<CodeScheme::PlanarErasure>(*erasure);
+    }
+
     std::shared_ptr<CodeScheme::PlanarSyndrome> get_syndrome() const {
         return scheme->get_syndrome();
     }
@@ -0,0 +1,181 @@
+#include "shot_file.hpp"
+#include "exception.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ErrorDynamics {
+
+namespace {
+
+const char magic[8] = {'S', 'C', 'S', 'H', 'O', 'T', 'S', '1'};
+const size_t noise_bytes = 64;
+
+// offsets of the fields in the header
+namespace offset {
+const size_t x = 8, y = 12, rounds = 16, chunk_shots = 20, shots = 24, seed = 32, p = 40, noise = 48;
+}
+
+template<typename T>
+void put(uint8_t* buffer, size_t at, T value) {
+    std::memcpy(buffer + at, &value, sizeof(T));
+}
+
+template<typename T>
+T get(const uint8_t* buffer, size_t at) {
+    T value;
+    std::memcpy(&value, buffer + at, sizeof(T));
+    return value;
+}
+
+}
+
+ShotFileWriter::ShotFileWriter(std::string _path, const ShotFileHeader& _header) : path(_path), header(_header), pending(0) {
+    if(header.x <= 0 || header.y <= 0 || header.rounds <= 0 || header.chunk_shots <= 0)
+        throw Util::BadShape(std::string("A shot file needs a positive shape, number of rounds and chunk size."));
+    if(header.noise.size() >= noise_bytes)
+        throw Util::BadFile(std::string("The noise description of a shot file is too long: ") + header.noise);
+    header.shots = 0;
+    chunk = std::vector<uint8_t>(header.chunk_shots * header.record_bytes());
+    file.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if(!file.is_open())
+        throw Util::BadFile(std::string("Cannot write the shot file: ") + path);
+    write_header();
+}
+
+ShotFileWriter::~ShotFileWriter() {
+    try {
+        close();
+    }
+    catch(...) {}
+}
+
+void ShotFileWriter::write_header() {
+    uint8_t buffer[ShotFileHeader::header_bytes] = {};
+    std::memcpy(buffer, magic, sizeof(magic));
+    put<int32_t>(buffer, offset::x, header.x);
+    put<int32_t>(buffer, offset::y, header.y);
+    put<int32_t>(buffer, offset::rounds, header.rounds);
+    put<int32_t>(buffer, offset::chunk_shots, header.chunk_shots);
+    put<int64_t>(buffer, offset::shots, header.shots);
+    put<uint64_t>(buffer, offset::seed, header.seed);
+    put<double>(buffer, offset::p, header.p);
+    std::memcpy(buffer + offset::noise, header.noise.data(), header.noise.size());
+    file.seekp(0);
+    file.write((const char*)buffer, sizeof(buffer));
+}
+
+void ShotFileWriter::append(const std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>& syndromes, const CodeScheme::PlanarError& error) {
+    if((int)syndromes.size() != header.rounds || !(error.get_shape() == CodeScheme::PlanarShape(header.x, header.y)))
+        throw Util::BadShape(std::string("The shot does not match the shape and rounds of the shot file."));
+    int x = header.x, y = header.y;
+    auto p = chunk.data() + pending * header.record_bytes();
+    std::memset(p, 0, header.record_bytes());
+    int width = (y + 7) / 8;
+    for(auto& syndrome: syndromes) {
+        auto values = syndrome->data();
+        for(int i = 0; i < x; i++) {
+            for(int j = 0; j < y; j++) {
+                if(values[i * y + j])
+                    p[i * width + j / 8] |= (uint8_t)(0x80 >> (j % 8));
+            }
+        }
+        p += header.syndrome_bytes();
+    }
+    width = (y + 3) / 4;
+    auto values = error.data();
+    for(int i = 0; i < x; i++) {
+        for(int j = 0; j < y; j++)
+            p[i * width + j / 4] |= (uint8_t)((values[i * y + j] & 3) << (6 - 2 * (j % 4)));
+    }
+    if(++pending == header.chunk_shots)
+        flush();
+}
+
+void ShotFileWriter::flush() {
+    if(!file.is_open() || pending == 0)
+        return;
+    file.seekp(ShotFileHeader::header_bytes + header.shots * header.record_bytes());
+    file.write((const char*)chunk.data(), pending * header.record_bytes());
+    file.flush();
+    // the count last: a reader never sees a shot which is not fully written
+    header.shots += pending;
+    pending = 0;
+    write_header();
+    file.flush();
+    if(!file)
+        throw Util::BadFile(std::string("Cannot write the shot file: ") + path);
+}
+
+void ShotFileWriter::close() {
+    if(!file.is_open())
+        return;
+    flush();
+    file.close();
+}
+
+ShotFileReader::ShotFileReader(std::string path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw Util::BadFile(std::string("Cannot open the shot file: ") + path);
+    struct stat info;
+    if(fstat(fd, &info) != 0 || (size_t)info.st_size < ShotFileHeader::header_bytes) {
+        ::close(fd);
+        throw Util::BadFile(path + ": not a shot file");
+    }
+    length = info.st_size;
+    auto address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file open
+    ::close(fd);
+    if(address == MAP_FAILED)
+        throw Util::BadFile(std::string("Cannot map the shot file: ") + path);
+    map = (const uint8_t*)address;
+
+    if(std::memcmp(map, magic, sizeof(magic)) != 0) {
+        munmap((void*)map, length);
+        throw Util::BadFile(path + ": not a shot file");
+    }
+    header.x = get<int32_t>(map, offset::x);
+    header.y = get<int32_t>(map, offset::y);
+    header.rounds = get<int32_t>(map, offset::rounds);
+    header.chunk_shots = get<int32_t>(map, offset::chunk_shots);
+    header.shots = get<int64_t>(map, offset::shots);
+    header.seed = get<uint64_t>(map, offset::seed);
+    header.p = get<double>(map, offset::p);
+    header.noise = std::string((const char*)map + offset::noise, strnlen((const char*)map + offset::noise, noise_bytes));
+    if(header.x <= 0 || header.y <= 0 || header.rounds <= 0 || header.shots < 0 ||
+       ShotFileHeader::header_bytes + header.shots * header.record_bytes() > length) {
+        munmap((void*)map, length);
+        throw Util::BadFile(path + ": a damaged shot file");
+    }
+}
+
+ShotFileReader::~ShotFileReader() {
+    munmap((void*)map, length);
+}
+
+PlanarData ShotFileReader::get_data(long long n) const {
+    if(n < 0 || n >= header.shots)
+        throw Util::BadIndex(std::string("No such shot in the shot file: ") + std::to_string(n));
+    int x = header.x, y = header.y;
+    auto symptoms = std::vector<int>(header.rounds * x * y);
+    auto paulis = std::vector<int>(x * y);
+    read_shot(n, symptoms.data(), paulis.data());
+    auto syndromes = std::make_shared<std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>>();
+    for(int t = 0; t < header.rounds; t++) {
+        auto syndrome = std::make_shared<CodeScheme::PlanarSyndrome>(x, y);
+        for(int i = 0; i < x; i++) {
+            for(int j = 0; j < y; j++) {
+                if(symptoms[(t * x + i) * y + j])
+                    syndrome->change_symptom(CodeScheme::PlanarIndex(i, j));
+            }
+        }
+        syndromes->push_back(syndrome);
+    }
+    return std::make_pair(syndromes, std::make_shared<CodeScheme::PlanarError>(x, y, paulis));
+}
+
+}
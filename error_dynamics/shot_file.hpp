@@ -0,0 +1,108 @@
+#pragma once
+
+#include "planar_surface_code.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ErrorDynamics {
+
+struct ShotFileHeader {
+    /*
+    A shot file is a 128 byte header followed by the records of its shots, record_bytes() each:
+        rounds syndrome change planes, 1 bit per site, 8 per byte along y, most significant bit first
+        one error plane, the Pauli in 2 bits per qubit, 4 per byte along y, most significant bits first
+    The shots are appended a chunk of chunk_shots at a time and shots is rewritten after every chunk,
+    so a file cut short by a crash reads up to its last complete chunk. Native byte order.
+    noise, p and seed describe how the shots were sampled, noise is at most 63 characters.
+    */
+    int x, y, rounds, chunk_shots;
+    long long shots;
+    unsigned long long seed;
+    double p;
+    std::string noise;
+
+    inline ShotFileHeader() : x(0), y(0), rounds(1), chunk_shots(4096), shots(0), seed(0), p(0) {}
+
+    inline size_t syndrome_bytes() const { return (size_t)x * ((y + 7) / 8); }
+    inline size_t error_bytes() const { return (size_t)x * ((y + 3) / 4); }
+    inline size_t record_bytes() const { return rounds * syndrome_bytes() + error_bytes(); }
+
+    static const size_t header_bytes = 128;
+};
+
+class ShotFileWriter {
+    private:
+    std::string path;
+    std::ofstream file;
+    ShotFileHeader header;
+    std::vector<uint8_t> chunk;
+    int pending;
+
+    void write_header();
+
+    public:
+    ShotFileWriter(std::string _path, const ShotFileHeader& _header);
+    ~ShotFileWriter();
+    ShotFileWriter(const ShotFileWriter&) = delete;
+    ShotFileWriter& operator=(const ShotFileWriter&) = delete;
+
+    void append(const std::vector<std::shared_ptr<CodeScheme::PlanarSyndrome>>& syndromes, const CodeScheme::PlanarError& error);
+    inline void append(const PlanarData& data) { append(*data.first, *data.second); }
+    // the shot of the last step, without copying it out of the simulator
+    inline void append(const PlanarSurfaceCode& code) { append(code.view_syndrome_changes(), code.view_last_error()); }
+    // write the pending shots and the count in the header
+    void flush();
+    void close();
+
+    inline const ShotFileHeader& get_header() const { return header; }
+    inline long long size() const { return header.shots + pending; }
+};
+
+class ShotFileReader {
+    /*
+    Maps a shot file read-only: the pages of the shots are loaded on access and dropped
+    by the kernel under memory pressure, whatever the size of the file.
+    */
+    private:
+    const uint8_t* map;
+    size_t length;
+    ShotFileHeader header;
+
+    public:
+    ShotFileReader(std::string path);
+    ~ShotFileReader();
+    ShotFileReader(const ShotFileReader&) = delete;
+    ShotFileReader& operator=(const ShotFileReader&) = delete;
+
+    inline const ShotFileHeader& get_header() const { return header; }
+    inline long long size() const { return header.shots; }
+    inline const uint8_t* record(long long n) const {
+        return map + ShotFileHeader::header_bytes + n * header.record_bytes();
+    }
+
+    // shot n unpacked: rounds * x * y symptoms and x * y Paulis, row by row
+    template<typename T>
+    void read_shot(long long n, T* syndromes, T* error) const {
+        auto p = record(n);
+        int x = header.x, y = header.y;
+        int width = (y + 7) / 8;
+        for(int t = 0; t < header.rounds; t++, p += header.syndrome_bytes()) {
+            for(int i = 0; i < x; i++) {
+                for(int j = 0; j < y; j++)
+                    *(syndromes++) = (T)((p[i * width + j / 8] >> (7 - j % 8)) & 1);
+            }
+        }
+        width = (y + 3) / 4;
+        for(int i = 0; i < x; i++) {
+            for(int j = 0; j < y; j++)
+                *(error++) = (T)((p[i * width + j / 4] >> (6 - 2 * (j % 4))) & 3);
+        }
+    }
+    PlanarData get_data(long long n) const;
+};
+
+}
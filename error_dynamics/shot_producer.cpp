@@ -0,0 +1,106 @@
+#include "shot_producer.hpp"
+#include "exception.hpp"
+#include "seed.hpp"
+
+namespace ErrorDynamics {
+
+ShotProducer::ShotProducer(
+    int _d, int _rounds, int _batch_size,
+    std::function<std::shared_ptr<ErrorModel::ErrorModelBase>()> _make_model,
+    unsigned long long _seed, int threads, int _capacity, long long _batches
+) : d(_d), rounds(_rounds), batch_size(_batch_size), capacity(_capacity), batches(_batches), seed(_seed), make_model(_make_model),
+    next_batch(0), consumed(0), stopped(false) {
+    if(d <= 0 || rounds <= 0 || batch_size <= 0 || threads <= 0 || capacity <= 0)
+        throw Util::BadShape(std::string("A shot producer needs a positive size, rounds, batch size, thread count and capacity."));
+    slots = std::vector<ShotBatch>(capacity);
+    ready = std::vector<bool>(capacity, false);
+    for(int _ = 0; _ < threads; _++)
+        workers.push_back(std::thread(&ShotProducer::work, this));
+}
+
+ShotProducer::~ShotProducer() {
+    stop();
+    for(auto& worker: workers)
+        worker.join();
+}
+
+void ShotProducer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    slot_free.notify_all();
+    slot_ready.notify_all();
+}
+
+void ShotProducer::work() {
+    auto model = make_model();
+    auto code = PlanarSurfaceCode(d, model);
+    while(true) {
+        long long k;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slot_free.wait(lock, [this]() {
+                return stopped || (batches >= 0 && next_batch >= batches) || next_batch < consumed + capacity;
+            });
+            if(stopped || (batches >= 0 && next_batch >= batches))
+                return;
+            k = next_batch++;
+        }
+        // the slot of batch k is free until it is ready: the batch capacity before it is consumed
+        auto& batch = slots[k % capacity];
+        batch.index = k;
+        model->seed(Util::derive_seed(seed, 0, k));
+        simulate(code, batch);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[k % capacity] = true;
+        }
+        slot_ready.notify_all();
+    }
+}
+
+void ShotProducer::simulate(PlanarSurfaceCode& code, ShotBatch& batch) {
+    size_t plane = (size_t)d * d;
+    batch.size = batch_size;
+    batch.data.resize(batch_size * (1 + rounds) * plane);
+    batch.target.resize(batch_size * plane);
+    for(int b = 0; b < batch_size; b++) {
+        auto data = batch.data.data() + b * (1 + rounds) * plane;
+        for(int i = 0; i < d; i++) {
+            for(int j = 0; j < d; j++)
+                data[i * d + j] = (uint8_t)((i + j) % 2);
+        }
+        code.step(rounds);
+        auto& syndromes = code.view_syndrome_changes();
+        for(int t = 0; t < rounds; t++) {
+            auto values = syndromes[t]->data();
+            for(size_t n = 0; n < plane; n++)
+                data[(t + 1) * plane + n] = (uint8_t)values[n];
+        }
+        auto values = code.view_last_error().data();
+        for(size_t n = 0; n < plane; n++)
+            batch.target[b * plane + n] = (uint8_t)values[n];
+        code.reset();
+    }
+}
+
+bool ShotProducer::next(ShotBatch& batch) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        slot_ready.wait(lock, [this]() {
+            return stopped || (batches >= 0 && consumed >= batches) || ready[consumed % capacity];
+        });
+        if(stopped || (batches >= 0 && consumed >= batches))
+            return false;
+        int slot = consumed % capacity;
+        // the buffers of the caller go back into the ring and are reused
+        std::swap(batch, slots[slot]);
+        ready[slot] = false;
+        consumed++;
+    }
+    slot_free.notify_all();
+    return true;
+}
+
+}
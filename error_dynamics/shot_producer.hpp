@@ -0,0 +1,69 @@
+#pragma once
+
+#include "planar_surface_code.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ErrorDynamics {
+
+struct ShotBatch {
+    /*
+    size shots in the layout of MLDecoder::to_pyarray, one byte per value:
+        data    (size, 1 + rounds, x, y), channel 0 is 1 on the measure qubits, the others the syndrome changes
+        target  (size, x, y), the Pauli errors
+    */
+    long long index;
+    int size;
+    std::vector<uint8_t> data, target;
+};
+
+class ShotProducer {
+    /*
+    Simulates batches of shots on worker threads, each with its own code and error model,
+    into a ring of capacity batches, and hands them out in order. Batch k is sampled from
+    a random stream of its own derived from the seed, so the batches do not depend on the
+    number of threads. batches < 0 produces until stop().
+    */
+    private:
+    int d, rounds, batch_size, capacity;
+    long long batches;
+    unsigned long long seed;
+    std::function<std::shared_ptr<ErrorModel::ErrorModelBase>()> make_model;
+
+    std::mutex mutex;
+    std::condition_variable slot_free, slot_ready;
+    std::vector<ShotBatch> slots;
+    std::vector<bool> ready;
+    long long next_batch, consumed;
+    bool stopped;
+    std::vector<std::thread> workers;
+
+    void work();
+    void simulate(PlanarSurfaceCode& code, ShotBatch& batch);
+
+    public:
+    ShotProducer() = delete;
+    ShotProducer(
+        int _d, int _rounds, int _batch_size,
+        std::function<std::shared_ptr<ErrorModel::ErrorModelBase>()> _make_model,
+        unsigned long long _seed, int threads, int _capacity, long long _batches = -1
+    );
+    ~ShotProducer();
+    ShotProducer(const ShotProducer&) = delete;
+    ShotProducer& operator=(const ShotProducer&) = delete;
+
+    // waits for the next batch, false once all batches are handed out or after stop()
+    bool next(ShotBatch& batch);
+    void stop();
+
+    inline CodeScheme::PlanarShape get_shape() const { return CodeScheme::PlanarShape(d, d); }
+    inline int get_rounds() const { return rounds; }
+};
+
+}
@@ -42,4 +42,17 @@ const char* BadIndex::what() const noexcept{
     return info.c_str();
 }
 
+BadFile::BadFile(std::string _info){
+    info = _info;
+}
+
+BadFile& BadFile::operator=(const BadFile& other){
+    info = other.info;
+    return *this;
+}
+
+const char* BadFile::what() const noexcept{
+    return info.c_str();
+}
+
 }}
\ No newline at end of file
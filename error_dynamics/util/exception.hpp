@@ -36,4 +36,14 @@ class BadIndex: public std::exception{
     const char* what() const noexcept;
 };
 
+class BadFile: public std::exception{
+    private:
+    std::string info;
+    
+    public:
+    BadFile(std::string _info);
+    BadFile& operator=(const BadFile& other);
+    const char* what() const noexcept;
+};
+
 }}
\ No newline at end of file
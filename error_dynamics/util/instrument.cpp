@@ -0,0 +1,162 @@
+#include "instrument.hpp"
+
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace ErrorDynamics{
+namespace Util{
+namespace Instrument{
+
+const char* name(Counter counter) {
+    static const char* names[num_counter] = {"steps", "decodes", "defects", "predecoded", "vertices", "edges", "batches", "allocations"};
+    return names[(int)counter];
+}
+
+const char* name(Timer timer) {
+    static const char* names[num_timer] = {"step", "predecode", "graph", "matching", "correction", "generate_batch"};
+    return names[(int)timer];
+}
+
+const char* name(Histogram histogram) {
+    static const char* names[num_histogram] = {"defects", "vertices"};
+    return names[(int)histogram];
+}
+
+Stats::Stats() {
+    counter.fill(0);
+    nanoseconds.fill(0);
+    for(auto& buckets: histogram)
+        buckets.fill(0);
+}
+
+Stats& Stats::operator+=(const Stats& other) {
+    for(int c = 0; c < num_counter; c++)
+        counter[c] += other.counter[c];
+    for(int t = 0; t < num_timer; t++)
+        nanoseconds[t] += other.nanoseconds[t];
+    for(int h = 0; h < num_histogram; h++) {
+        for(int b = 0; b < num_bucket; b++)
+            histogram[h][b] += other.histogram[h][b];
+    }
+    return *this;
+}
+
+Stats& Stats::operator-=(const Stats& other) {
+    for(int c = 0; c < num_counter; c++)
+        counter[c] -= other.counter[c];
+    for(int t = 0; t < num_timer; t++)
+        nanoseconds[t] -= other.nanoseconds[t];
+    for(int h = 0; h < num_histogram; h++) {
+        for(int b = 0; b < num_bucket; b++)
+            histogram[h][b] -= other.histogram[h][b];
+    }
+    return *this;
+}
+
+namespace detail {
+
+ThreadRecord::ThreadRecord() {
+    for(auto& value: counter)
+        value.store(0);
+    for(auto& value: nanoseconds)
+        value.store(0);
+    for(auto& buckets: histogram) {
+        for(auto& value: buckets)
+            value.store(0);
+    }
+}
+
+thread_local ThreadRecord* current = nullptr;
+
+// the records outlive their threads, so that the totals keep what finished threads recorded
+static std::mutex registry_mutex;
+static std::deque<ThreadRecord> registry;
+
+ThreadRecord* register_thread() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.emplace_back();
+    return &registry.back();
+}
+
+static Stats read(const ThreadRecord& record) {
+    auto ret = Stats();
+    for(int c = 0; c < num_counter; c++)
+        ret.counter[c] = record.counter[c].load(std::memory_order_relaxed);
+    for(int t = 0; t < num_timer; t++)
+        ret.nanoseconds[t] = record.nanoseconds[t].load(std::memory_order_relaxed);
+    for(int h = 0; h < num_histogram; h++) {
+        for(int b = 0; b < num_bucket; b++)
+            ret.histogram[h][b] = record.histogram[h][b].load(std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+}
+
+Stats thread_stats() {
+    if(!enabled)
+        return Stats();
+    return detail::read(detail::local());
+}
+
+Stats total_stats() {
+    auto ret = Stats();
+    std::lock_guard<std::mutex> lock(detail::registry_mutex);
+    for(auto& record: detail::registry)
+        ret += detail::read(record);
+    return ret;
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(detail::registry_mutex);
+    for(auto& record: detail::registry) {
+        for(auto& value: record.counter)
+            value.store(0);
+        for(auto& value: record.nanoseconds)
+            value.store(0);
+        for(auto& buckets: record.histogram) {
+            for(auto& value: buckets)
+                value.store(0);
+        }
+    }
+}
+
+}}}
+
+#ifdef ENABLE_INSTRUMENTATION
+// count the heap allocations of the threads which record; a thread is not
+// counted before its first record, so registering it cannot recurse here
+namespace {
+
+inline void* counted_allocation(std::size_t size) {
+    if(ErrorDynamics::Util::Instrument::detail::current)
+        ErrorDynamics::Util::Instrument::detail::add(ErrorDynamics::Util::Instrument::detail::current->counter[(int)ErrorDynamics::Util::Instrument::Counter::ALLOCATIONS], 1);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+}
+
+void* operator new(std::size_t size) {
+    void* ret = counted_allocation(size);
+    if(!ret)
+        throw std::bad_alloc();
+    return ret;
+}
+
+void* operator new[](std::size_t size) {
+    void* ret = counted_allocation(size);
+    if(!ret)
+        throw std::bad_alloc();
+    return ret;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_allocation(size); }
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
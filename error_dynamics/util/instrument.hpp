@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace ErrorDynamics{
+namespace Util{
+namespace Instrument{
+
+/*
+Counters, timers and histograms of the hot paths, kept per thread so that
+recording never takes a lock. They are compiled in only with the CMake option
+ENABLE_INSTRUMENTATION; without it the INSTRUMENT_* macros expand to nothing
+and the statistics stay zero.
+*/
+#ifdef ENABLE_INSTRUMENTATION
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+enum class Counter {
+    STEPS, DECODES, DEFECTS, PREDECODED, VERTICES, EDGES, BATCHES, ALLOCATIONS, NUM
+};
+
+enum class Timer {
+    STEP, PREDECODE, GRAPH, MATCHING, CORRECTION, GENERATE_BATCH, NUM
+};
+
+enum class Histogram {
+    DEFECTS, VERTICES, NUM
+};
+
+const int num_counter = (int)Counter::NUM;
+const int num_timer = (int)Timer::NUM;
+const int num_histogram = (int)Histogram::NUM;
+// bucket 0 holds 0, bucket b > 0 holds [2^(b-1), 2^b)
+const int num_bucket = 32;
+
+const char* name(Counter counter);
+const char* name(Timer timer);
+const char* name(Histogram histogram);
+
+struct Stats {
+    std::array<uint64_t, num_counter> counter;
+    std::array<uint64_t, num_timer> nanoseconds;
+    std::array<std::array<uint64_t, num_bucket>, num_histogram> histogram;
+
+    Stats();
+    Stats& operator+=(const Stats& other);
+    Stats& operator-=(const Stats& other);
+};
+
+inline Stats operator-(Stats a, const Stats& b) { return a -= b; }
+
+// everything the calling thread recorded so far
+Stats thread_stats();
+// the sum over every thread, exact once no thread is recording
+Stats total_stats();
+void reset();
+
+namespace detail {
+
+struct ThreadRecord {
+    std::array<std::atomic<uint64_t>, num_counter> counter;
+    std::array<std::atomic<uint64_t>, num_timer> nanoseconds;
+    std::array<std::array<std::atomic<uint64_t>, num_bucket>, num_histogram> histogram;
+    ThreadRecord();
+};
+
+extern thread_local ThreadRecord* current;
+ThreadRecord* register_thread();
+
+inline ThreadRecord& local() {
+    if(!current)
+        current = register_thread();
+    return *current;
+}
+
+// only the owning thread writes, readers only need a torn-free value
+inline void add(std::atomic<uint64_t>& value, uint64_t n) {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline int bucket(uint64_t value) {
+    if(value == 0)
+        return 0;
+    int b = 64 - __builtin_clzll(value);
+    return b < num_bucket ? b : num_bucket - 1;
+}
+
+}
+
+inline void count(Counter counter, uint64_t n) {
+    detail::add(detail::local().counter[(int)counter], n);
+}
+
+inline void record(Histogram histogram, uint64_t value) {
+    detail::add(detail::local().histogram[(int)histogram][detail::bucket(value)], 1);
+}
+
+class ScopedTimer {
+    Timer timer;
+    std::chrono::steady_clock::time_point begin;
+
+    public:
+    inline ScopedTimer(Timer _timer) : timer(_timer), begin(std::chrono::steady_clock::now()) {}
+    inline ~ScopedTimer() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        detail::add(detail::local().nanoseconds[(int)timer], (uint64_t)elapsed);
+    }
+};
+
+}}}
+
+#ifdef ENABLE_INSTRUMENTATION
+#define INSTRUMENT_CONCAT_(a, b) a##b
+#define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+#define INSTRUMENT_COUNT(counter, n) ErrorDynamics::Util::Instrument::count(ErrorDynamics::Util::Instrument::Counter::counter, n)
+#define INSTRUMENT_RECORD(histogram, value) ErrorDynamics::Util::Instrument::record(ErrorDynamics::Util::Instrument::Histogram::histogram, value)
+#define INSTRUMENT_TIME(timer) ErrorDynamics::Util::Instrument::ScopedTimer INSTRUMENT_CONCAT(instrument_timer_, __LINE__)(ErrorDynamics::Util::Instrument::Timer::timer)
+#else
+#define INSTRUMENT_COUNT(counter, n) ((void)0)
+#define INSTRUMENT_RECORD(histogram, value) ((void)0)
+#define INSTRUMENT_TIME(timer) ((void)0)
+#endif
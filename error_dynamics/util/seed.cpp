@@ -0,0 +1,17 @@
+#include "seed.hpp"
+
+namespace ErrorDynamics{
+namespace Util{
+
+unsigned long long derive_seed(unsigned long long seed, unsigned long long stream, unsigned long long batch) {
+    auto split_mix = [](unsigned long long z) {
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    };
+    return split_mix(split_mix(split_mix(seed) ^ stream) ^ batch);
+}
+
+}
+}
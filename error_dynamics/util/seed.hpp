@@ -0,0 +1,10 @@
+#pragma once
+
+namespace ErrorDynamics{
+namespace Util{
+
+// SplitMix64 of a seed, a stream and a batch: every batch of every stream owns an independent random stream
+unsigned long long derive_seed(unsigned long long seed, unsigned long long stream, unsigned long long batch);
+
+}
+}
@@ -0,0 +1,38 @@
+#include "sparse_sampler.hpp"
+#include "exception.hpp"
+
+#include <map>
+#include <string>
+
+namespace ErrorDynamics{
+namespace Util{
+
+SparseSampler::SparseSampler() : max_rate(0) {}
+
+SparseSampler::SparseSampler(const std::vector<double>& _rate) : rate(_rate), max_rate(0) {
+    auto grouped = std::map<int, std::vector<int>>();
+    for(int n = 0; n < (int)rate.size(); n++) {
+        if(rate[n] < 0 || rate[n] > 1)
+            throw BadType(std::string("The rates of a sampler should be probabilities."));
+        max_rate = std::max(max_rate, rate[n]);
+        if(rate[n] == 0)
+            continue;
+        int exponent;
+        double mantissa = std::frexp(rate[n], &exponent);
+        // a power of two is the bound of its own class
+        grouped[mantissa == 0.5 ? exponent - 1 : exponent].push_back(n);
+    }
+    for(auto& group: grouped)
+        classes.push_back(RateClass{std::ldexp(1.0, group.first), group.second});
+}
+
+std::vector<double> matching_weight(const std::vector<double>& rate) {
+    // the weight of a never seen fault stays finite for the matching
+    const double min_rate = 1e-15;
+    auto ret = std::vector<double>(rate.size());
+    for(int n = 0; n < (int)ret.size(); n++)
+        ret[n] = -std::log(std::max(rate[n], min_rate));
+    return ret;
+}
+
+}}
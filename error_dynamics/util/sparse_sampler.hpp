@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace ErrorDynamics{
+namespace Util{
+
+class SparseSampler {
+    /*
+    Draws which of a fixed set of independent events happen, each with its own rate, in
+    O(events drawn + classes). The events are grouped into rate classes (bound / 2, bound]
+    by powers of two; a class is walked by geometric skips at its bound and each candidate
+    is kept with probability rate / bound, so at least half of the candidates are kept.
+    scale multiplies every rate at draw time.
+    */
+    struct RateClass {
+        double bound;
+        std::vector<int> events;
+    };
+    std::vector<RateClass> classes;
+    std::vector<double> rate;
+    double max_rate;
+
+    public:
+    SparseSampler();
+    SparseSampler(const std::vector<double>& _rate);
+
+    inline double get_max_rate() const { return max_rate; }
+    inline int size() const { return rate.size(); }
+
+    // calls visit(event) for every event drawn, in increasing order within a class
+    template<class Engine, class Visit>
+    void sample(Engine& engine, double scale, Visit visit) const {
+        std::uniform_real_distribution<double> uniform(0, 1);
+        for(auto& rate_class: classes) {
+            double bound = std::min(1.0, rate_class.bound * scale);
+            if(bound <= 0)
+                continue;
+            double log_miss = std::log1p(-bound);
+            int n_events = rate_class.events.size();
+            // the next candidate is a geometric number of events away, each event a candidate with probability bound
+            for(int n = -1; ; ) {
+                double skip = (bound >= 1 ? 0 : std::floor(std::log(1 - uniform(engine)) / log_miss));
+                if(skip >= n_events - 1 - n)
+                    break;
+                n += 1 + (int)skip;
+                int event = rate_class.events[n];
+                if(uniform(engine) * bound < rate[event] * scale)
+                    visit(event);
+            }
+        }
+    }
+};
+
+// the matching weights -log p of the rates of a set of faults, finite for a fault of rate 0
+std::vector<double> matching_weight(const std::vector<double>& rate);
+
+}}
@@ -2,4 +2,7 @@
 
 #include "constant.hpp"
 #include "exception.hpp"
-#include "display.hpp"
\ No newline at end of file
+#include "display.hpp"
+#include "instrument.hpp"
+#include "seed.hpp"
+#include "sparse_sampler.hpp"
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+// stands in for a network behind Python: one call at a time, at a fixed cost whatever the batch size
+class SlowBatchDecoder: public Dc::BatchDecoder {
+    shared_ptr<Dc::Matching::StandardMWPMDecoder> decoder;
+    chrono::microseconds overhead;
+    mutex interpreter;
+    public:
+    SlowBatchDecoder(double p, Err::CodeScheme::PlanarShape shape, int _overhead)
+        : decoder(make_shared<Dc::Matching::StandardMWPMDecoder>(p, p, p, 0, false, shape)), overhead(_overhead) {}
+    using Dc::BatchDecoder::operator();
+    shared_ptr<Err::CodeScheme::PlanarError> operator() (Err::PlanarData data) {
+        lock_guard<mutex> lock(interpreter);
+        this_thread::sleep_for(overhead);
+        return (*decoder)(data);
+    }
+    vector<shared_ptr<Err::CodeScheme::PlanarError>> operator() (vector<Err::PlanarData> datas) {
+        lock_guard<mutex> lock(interpreter);
+        this_thread::sleep_for(overhead);
+        auto ret = vector<shared_ptr<Err::CodeScheme::PlanarError>>();
+        for(auto& data: datas)
+            ret.push_back((*decoder)(data));
+        return ret;
+    }
+};
+
+// every thread simulates its own shots and queries the shared decoder one shot at a time
+double run(int d, double p, int threads, int n, shared_ptr<Dc::DecoderBase> decoder, int& logical_errors) {
+    atomic<int> failures(0);
+    auto begin = chrono::steady_clock::now();
+    auto workers = vector<thread>();
+    for(int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            auto error_model = make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, 0);
+            error_model->seed(t + 1);
+            auto code = Err::PlanarSurfaceCode(d, error_model);
+            for(int _ = 0; _ < n; _++) {
+                code.step(1);
+                auto data = code.get_data();
+                auto correction = (*decoder)(data);
+                if(!(data.second * correction)->is_correct())
+                    failures++;
+                code.reset();
+            }
+        });
+    }
+    for(auto& worker: workers)
+        worker.join();
+    logical_errors = failures;
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+int main() {
+    int d = 7, n = 200, overhead = 1000;
+    double p = 0.01;
+    auto shape = Err::PlanarSurfaceCode(d, make_shared<Err::ErrorModel::IIDError>(0, 0, 0, 0)).get_shape();
+    for(int threads: {1, 4, 16}) {
+        int err_plain, err_batched;
+        auto decoder = make_shared<SlowBatchDecoder>(p, shape, overhead);
+        auto batching = make_shared<Dc::Batching::BatchingDecoder>(decoder, 64, 200);
+        double t_plain = run(d, p, threads, n, decoder, err_plain);
+        double t_batched = run(d, p, threads, n, batching, err_batched);
+        cout << "threads = " << threads
+             << " | direct " << t_plain << "s, p_L = " << (double)err_plain / (threads * n)
+             << " | batched " << t_batched << "s, p_L = " << (double)err_batched / (threads * n)
+             << " | speedup " << t_plain / t_batched
+             << " | mean batch " << batching->mean_batch() << endl;
+    }
+    return 0;
+}
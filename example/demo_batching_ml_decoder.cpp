@@ -0,0 +1,50 @@
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <pybind11/embed.h>
+
+using namespace std;
+namespace py = pybind11;
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+int main() {
+    py::scoped_interpreter guard{};
+
+    int d = 7, threads = 8, n = 50;
+    double p = 0.01;
+    auto ml_decoder = make_shared<Dc::ML::MLDecoder>("test_io");
+    atomic<int> decoded(0);
+    long long batches;
+    double mean_batch;
+    {
+        // the main thread holds the GIL since the interpreter started, and the dispatcher takes it for every batch:
+        // release it while the workers wait on their futures, and until the dispatcher is joined
+        py::gil_scoped_release release;
+        auto batching = make_shared<Dc::Batching::BatchingDecoder>(ml_decoder, 64, 200);
+        auto workers = vector<thread>();
+        for(int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                auto error_model = make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, 0);
+                error_model->seed(t + 1);
+                auto code = Err::PlanarSurfaceCode(d, error_model);
+                for(int _ = 0; _ < n; _++) {
+                    code.step(1);
+                    (*batching)(code.get_data());
+                    decoded++;
+                    code.reset();
+                }
+            });
+        }
+        for(auto& worker: workers)
+            worker.join();
+        batches = batching->get_batches();
+        mean_batch = batching->mean_batch();
+    }
+    cout << decoded << " shots from " << threads << " threads in " << batches << " calls to the network, mean batch " << mean_batch << endl;
+    return 0;
+}
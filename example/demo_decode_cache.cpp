@@ -0,0 +1,49 @@
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <iostream>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+// the test_batch workload of exec/MWPM_2d, with an optional decode cache in front of the decoder
+double run(int d, double p, int n, shared_ptr<Dc::Cache::DecodeCache> cache, int& logical_errors) {
+    auto error_model = make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, 0);
+    auto code = Err::PlanarSurfaceCode(d, error_model);
+    shared_ptr<Dc::DecoderBase> decoder = make_shared<Dc::Matching::StandardMWPMDecoder>(p, p, p, 0, false, code.get_shape());
+    if(cache)
+        decoder = make_shared<Dc::Cache::CachedDecoder>(decoder, cache);
+
+    logical_errors = 0;
+    auto begin = chrono::steady_clock::now();
+    for(int _ = 0; _ < n; _++) {
+        code.step(1);
+        auto data = code.get_data();
+        auto correction = (*decoder)(data);
+        if(!(data.second * correction)->is_correct())
+            logical_errors++;
+        code.reset();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+int main() {
+    int n = 100000;
+    for(int d: {7, 11, 15}) {
+        for(double p: {0.001, 0.003, 0.005}) {
+            int err_plain, err_cached;
+            auto cache = make_shared<Dc::Cache::DecodeCache>(1 << 16, 8);
+            double t_plain = run(d, p, n, nullptr, err_plain);
+            double t_cached = run(d, p, n, cache, err_cached);
+            cout << "d = " << d << ", p = " << p
+                 << " | plain " << t_plain << "s, p_L = " << (double)err_plain / n
+                 << " | cached " << t_cached << "s, p_L = " << (double)err_cached / n
+                 << " | speedup " << t_plain / t_cached
+                 << " | hit rate " << cache->hit_rate()
+                 << " | entries " << cache->size() << endl;
+        }
+    }
+    return 0;
+}
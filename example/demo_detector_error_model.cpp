@@ -0,0 +1,89 @@
+#include "error_dynamics.hpp"
+#include <iostream>
+#include <cmath>
+#include <random>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+
+struct Moments {
+    double defects = 0, defects_squared = 0, logical = 0;
+    int n = 0;
+
+    void add(const Err::PlanarData& data) {
+        double count = 0;
+        for(auto& syndrome: *data.first) {
+            for(auto symptom: syndrome->to_vector())
+                count += symptom;
+        }
+        defects += count, defects_squared += count * count;
+        logical += (data.second->logical_error() != Err::Util::Pauli::I);
+        n++;
+    }
+    double mean() const { return defects / n; }
+    double variance_of_mean() const { return (defects_squared / n - mean() * mean()) / n; }
+};
+
+// the frequency of every event of a SparseSampler against its rate, the rates spread over several classes
+double sampler_max_z(int draws) {
+    auto rate = vector<double>();
+    // 1e6 draws see the rarest event about 300 times, enough for the normal approximation
+    for(int n = 0; n < 32; n++)
+        rate.push_back(0.3 * pow(0.8, n));
+    auto sampler = Err::Util::SparseSampler(rate);
+    auto count = vector<double>(rate.size(), 0);
+    mt19937 engine(5);
+    for(int _ = 0; _ < draws; _++)
+        sampler.sample(engine, 1.0, [&](int event) { count[event]++; });
+    double ret = 0;
+    for(int n = 0; n < (int)rate.size(); n++) {
+        double expected = draws * rate[n], sigma = sqrt(expected * (1 - rate[n]));
+        ret = max(ret, fabs(count[n] - expected) / sigma);
+    }
+    return ret;
+}
+
+int main() {
+    int n = 200000, rounds = 5;
+    double p = 0.01;
+    cout << "SparseSampler, 32 rates from 0.3 down to 3e-4: max |z| of the event frequencies " << sampler_max_z(1000000) << endl;
+
+    // with the gate and reset faults off, the circuit is the phenomenological model: a depolarized data qubit every round and flipped measurements
+    for(int d: {3, 5, 7}) {
+        auto shape = Err::CodeScheme::PlanarShape(d, d);
+        auto dem = Err::DetectorErrorModel(shape, rounds, Err::CircuitNoise(0, 0, p, p));
+        auto circuit = Moments();
+        mt19937 engine(1);
+        for(int _ = 0; _ < n; _++)
+            circuit.add(dem.sample(engine));
+
+        auto error_model = make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, p);
+        error_model->seed(2);
+        auto code = Err::PlanarSurfaceCode(d, error_model);
+        auto iid = Moments();
+        for(int _ = 0; _ < n; _++) {
+            code.step(rounds);
+            iid.add(code.get_data());
+            code.reset();
+        }
+
+        double z = (circuit.mean() - iid.mean()) / sqrt(circuit.variance_of_mean() + iid.variance_of_mean());
+        cout << "d = " << d << ", rounds = " << rounds << ", p = " << p
+             << " | defects per shot: detector error model " << circuit.mean() << ", IIDError " << iid.mean() << ", z = " << z
+             << " | logical error before decoding " << circuit.logical / n << ", " << iid.logical / n
+             << " | " << (fabs(z) < 4 ? "match" : "MISMATCH") << endl;
+    }
+
+    // the full circuit noise and the weights mwpm_weighted takes from it
+    for(int d: {3, 5, 7}) {
+        auto dem = Err::DetectorErrorModel(Err::CodeScheme::PlanarShape(d, d), rounds, Err::CircuitNoise(p));
+        auto circuit = Moments();
+        mt19937 engine(3);
+        for(int _ = 0; _ < n / 10; _++)
+            circuit.add(dem.sample(engine));
+        auto x_weight = dem.x_flip_weight();
+        cout << "d = " << d << ", circuit noise at " << p << " | " << dem.get_mechanisms().size() << " mechanisms, "
+             << circuit.mean() << " defects per shot, weight of the center qubit " << x_weight[(d / 2) * d + d / 2] << endl;
+    }
+    return 0;
+}
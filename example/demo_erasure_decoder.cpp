@@ -0,0 +1,51 @@
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <iostream>
+#include <chrono>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+// compare the peeling + erasure-weighted matching path with the erasure-blind MWPM path
+int main() {
+    int n = 10000;
+    for(int d: {7, 11, 15}) {
+        for(double pe: {0.05, 0.1, 0.2, 0.3}) {
+            for(double p: {0.0, 0.002}) {
+                auto error_model = make_shared<Err::ErrorModel::ErasureError>(pe, p / 3, p / 3, p / 3, 0);
+                auto code = Err::PlanarSurfaceCode(d, error_model);
+                // the MWPM path sees the erased qubits as depolarized with probability 3/4
+                double p_mwpm = pe * 3 / 4 + p;
+                auto mwpm_decoder = Dc::Matching::StandardMWPMDecoder(p_mwpm, p_mwpm, p_mwpm, 0, false, code.get_shape());
+                auto erasure_decoder = Dc::Erasure::ErasureDecoder((p > 0 ? p : 1e-6), false, code.get_shape());
+
+                int err_mwpm = 0, err_erasure = 0;
+                double t_mwpm = 0, t_erasure = 0;
+                for(int _ = 0; _ < n; _++) {
+                    code.step(1);
+                    auto data = code.get_data();
+                    auto erasure = code.get_erasure();
+
+                    auto begin = chrono::steady_clock::now();
+                    auto correction = mwpm_decoder(data);
+                    t_mwpm += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+                    if(!(data.second * correction)->is_correct())
+                        err_mwpm++;
+
+                    begin = chrono::steady_clock::now();
+                    correction = erasure_decoder(data, erasure);
+                    t_erasure += chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+                    if(!(data.second * correction)->is_correct())
+                        err_erasure++;
+                    code.reset();
+                }
+                cout << "d = " << d << ", pe = " << pe << ", p = " << p
+                     << " | MWPM " << t_mwpm << "s, p_L = " << (double)err_mwpm / n
+                     << " | erasure " << t_erasure << "s, p_L = " << (double)err_erasure / n
+                     << ", peeled " << (double)erasure_decoder.get_peeled() / n << endl;
+            }
+        }
+    }
+    return 0;
+}
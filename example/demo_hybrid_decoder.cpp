@@ -0,0 +1,56 @@
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <iostream>
+#include <chrono>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+// the test_batch workload of exec/MWPM_2d, decoded by MWPM alone or behind the local predecoder
+double run(int d, double p, int rounds, int n, shared_ptr<Dc::Hybrid::HybridDecoder>* hybrid, int& logical_errors) {
+    bool measurement_error = rounds > 1;
+    double pm = (measurement_error ? p * 2 / 3 : 0);
+    auto error_model = make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, pm);
+    error_model->seed(1);
+    auto code = Err::PlanarSurfaceCode(d, error_model);
+    shared_ptr<Dc::DecoderBase> decoder = make_shared<Dc::Matching::StandardMWPMDecoder>(p, p, p, pm, measurement_error, code.get_shape());
+    if(hybrid) {
+        auto predecoder = make_shared<Dc::Hybrid::LocalPredecoder>(code.get_shape(), measurement_error);
+        *hybrid = make_shared<Dc::Hybrid::HybridDecoder>(predecoder, decoder);
+        decoder = *hybrid;
+    }
+
+    logical_errors = 0;
+    auto begin = chrono::steady_clock::now();
+    for(int _ = 0; _ < n; _++) {
+        code.step(rounds);
+        auto data = code.get_data();
+        auto correction = (*decoder)(data);
+        if(!(data.second * correction)->is_correct())
+            logical_errors++;
+        code.reset();
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+}
+
+int main() {
+    int n = 20000;
+    for(int rounds: {1, 5}) {
+        for(int d: {7, 11, 15}) {
+            for(double p: {0.001, 0.003, 0.005}) {
+                int err_plain, err_hybrid;
+                shared_ptr<Dc::Hybrid::HybridDecoder> hybrid;
+                double t_plain = run(d, p, rounds, n, nullptr, err_plain);
+                double t_hybrid = run(d, p, rounds, n, &hybrid, err_hybrid);
+                cout << "d = " << d << ", p = " << p << ", rounds = " << rounds
+                     << " | mwpm " << n / t_plain << " shots/s, p_L = " << (double)err_plain / n
+                     << " | hybrid " << n / t_hybrid << " shots/s, p_L = " << (double)err_hybrid / n
+                     << " | speedup " << t_plain / t_hybrid
+                     << " | defect reduction " << hybrid->defect_reduction()
+                     << " | predecoded shots " << (double)hybrid->get_predecoded() / n << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "decoder.hpp"
+#include <iostream>
+#include <cmath>
+#include <random>
+
+using namespace std;
+namespace Nn = Decoder::Neural;
+
+Nn::Tensor random_tensor(vector<int> shape, mt19937& engine) {
+    auto ret = Nn::Tensor();
+    ret.shape = shape;
+    size_t size = 1;
+    for(int n: shape)
+        size *= n;
+    // the scale of a trained layer: the outputs stay of order 1
+    normal_distribution<float> normal(0, 0.1f);
+    for(size_t _ = 0; _ < size; _++)
+        ret.data.push_back(normal(engine));
+    return ret;
+}
+
+/*
+nn.Conv2d with stride 1 and a zero padding of half the kernel, term by term in double. The
+float sums of Conv2d are in another order, so they are compared relative to the sum of the
+magnitudes of their terms, which bounds the rounding error of any order; magnitude gets it.
+*/
+vector<double> reference_conv(const Nn::Tensor& weight, const Nn::Tensor& bias, const vector<float>& in, int x, int y, vector<double>& magnitude) {
+    int out_channel = weight.shape[0], in_channel = weight.shape[1], kx = weight.shape[2], ky = weight.shape[3];
+    auto ret = vector<double>((size_t)out_channel * x * y);
+    magnitude = vector<double>(ret.size());
+    for(int o = 0; o < out_channel; o++) {
+        for(int i = 0; i < x; i++) {
+            for(int j = 0; j < y; j++) {
+                double sum = bias.data[o], total = fabs(bias.data[o]);
+                for(int c = 0; c < in_channel; c++) {
+                    for(int a = 0; a < kx; a++) {
+                        for(int b = 0; b < ky; b++) {
+                            int ii = i + a - kx / 2, jj = j + b - ky / 2;
+                            if(ii < 0 || ii >= x || jj < 0 || jj >= y)
+                                continue;
+                            double term = (double)weight.data[(((size_t)o * in_channel + c) * kx + a) * ky + b] * in[((size_t)c * x + ii) * y + jj];
+                            sum += term, total += fabs(term);
+                        }
+                    }
+                }
+                ret[((size_t)o * x + i) * y + j] = sum;
+                magnitude[((size_t)o * x + i) * y + j] = total;
+            }
+        }
+    }
+    return ret;
+}
+
+int main() {
+    mt19937 engine(7);
+    normal_distribution<float> normal(0, 1);
+    double worst = 0;
+    // the kernels of TwoLevelLLD and TwoLevelHLD, and a rectangular one, on the planes of a few distances
+    for(auto kernel: vector<pair<int, int>>{{5, 5}, {3, 3}, {3, 5}, {1, 1}}) {
+        for(auto plane: vector<pair<int, int>>{{3, 3}, {7, 7}, {11, 11}, {5, 9}}) {
+            int in_channel = 6, out_channel = 16, x = plane.first, y = plane.second;
+            auto tensors = map<string, Nn::Tensor>();
+            tensors["conv.weight"] = random_tensor({out_channel, in_channel, kernel.first, kernel.second}, engine);
+            tensors["conv.bias"] = random_tensor({out_channel}, engine);
+            auto conv = Nn::Conv2d(tensors, "conv");
+            auto in = vector<float>((size_t)in_channel * x * y);
+            for(auto& value: in)
+                value = normal(engine);
+            auto out = vector<float>((size_t)out_channel * x * y);
+            conv(in.data(), x, y, out.data());
+            auto magnitude = vector<double>();
+            auto reference = reference_conv(tensors["conv.weight"], tensors["conv.bias"], in, x, y, magnitude);
+            double error = 0;
+            for(size_t n = 0; n < out.size(); n++)
+                error = max(error, fabs(out[n] - reference[n]) / magnitude[n]);
+            worst = max(worst, error);
+            cout << "Conv2d " << in_channel << " -> " << out_channel << ", kernel " << kernel.first << "x" << kernel.second
+                 << ", plane " << x << "x" << y << " | max relative error " << error << endl;
+        }
+    }
+
+    for(auto features: vector<pair<int, int>>{{32, 64}, {64, 4}, {7, 3}}) {
+        auto tensors = map<string, Nn::Tensor>();
+        tensors["fc.weight"] = random_tensor({features.second, features.first}, engine);
+        tensors["fc.bias"] = random_tensor({features.second}, engine);
+        auto fc = Nn::Linear(tensors, "fc");
+        auto in = vector<float>(features.first);
+        for(auto& value: in)
+            value = normal(engine);
+        auto out = vector<float>(features.second);
+        fc(in.data(), out.data());
+        double error = 0;
+        for(int o = 0; o < features.second; o++) {
+            double sum = tensors["fc.bias"].data[o], total = fabs(sum);
+            for(int k = 0; k < features.first; k++) {
+                double term = (double)tensors["fc.weight"].data[(size_t)o * features.first + k] * in[k];
+                sum += term, total += fabs(term);
+            }
+            error = max(error, fabs(out[o] - sum) / total);
+        }
+        worst = max(worst, error);
+        cout << "Linear " << features.first << " -> " << features.second << " | max relative error " << error << endl;
+    }
+
+    cout << (worst < 1e-6 ? "all layers match the reference to 1e-6" : "MISMATCH: a layer is off by more than 1e-6") << endl;
+    return worst < 1e-6 ? 0 : 1;
+}
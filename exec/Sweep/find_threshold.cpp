@@ -0,0 +1,32 @@
+#include "sweep.hpp"
+
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    if(argc < 2) {
+        cerr << "usage: " << argv[0] << " <config> [output]" << endl;
+        return 1;
+    }
+    try {
+        auto config = Sweep::SweepConfig::load(argv[1]);
+        if(argc >= 3)
+            config.output = argv[2];
+        auto search = Sweep::ThresholdSearch(config);
+        search.run();
+        search.write_results(config.output);
+        if(!config.threshold_output.empty())
+            search.write_threshold(config.threshold_output);
+
+        auto& fit = search.get_fit();
+        cout << "p_th = " << fit.p_th << " [" << fit.ci_low << ", " << fit.ci_high << "], nu = " << fit.nu
+             << ", chi2 = " << fit.chi2 << " over " << fit.num_points << " points, " << search.get_iterations() << " focused rounds" << endl;
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
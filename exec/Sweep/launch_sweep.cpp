@@ -0,0 +1,88 @@
+#include "sweep.hpp"
+
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+extern char** environ;
+
+int main(int argc, char** argv) {
+    if(argc < 3) {
+        cerr << "usage: " << argv[0] << " <config> <processes> [output]" << endl;
+        return 1;
+    }
+    try {
+        auto config = Sweep::SweepConfig::load(argv[1]);
+        int processes = stoi(argv[2]);
+        if(argc >= 4)
+            config.output = argv[3];
+        if(processes <= 0)
+            throw Sweep::BadConfig(string("The number of processes should be positive"));
+        if(!config.has_seed) {
+            random_device random_device{};
+            config.seed = ((unsigned long long)random_device() << 32) | random_device();
+            config.has_seed = true;
+        }
+
+        // run_sweep sits next to this executable
+        auto self = filesystem::path(argv[0]);
+        if(filesystem::exists("/proc/self/exe"))
+            self = filesystem::read_symlink("/proc/self/exe");
+        auto runner = (self.parent_path() / "run_sweep").string();
+        int threads = max(1, config.num_thread / processes);
+
+        auto children = vector<pid_t>();
+        auto logs = vector<string>();
+        for(int i = 0; i < processes; i++) {
+            auto shard = config;
+            shard.set_shard(to_string(i) + "/" + to_string(processes));
+            logs.push_back(shard.shard_log());
+            auto arguments = vector<string>({
+                runner, argv[1], config.output,
+                "--shard", to_string(i) + "/" + to_string(processes),
+                "--threads", to_string(threads),
+                "--seed", to_string(config.seed)
+            });
+            auto pointers = vector<char*>();
+            for(auto& argument: arguments)
+                pointers.push_back(argument.data());
+            pointers.push_back(nullptr);
+            pid_t child;
+            if(posix_spawn(&child, runner.c_str(), nullptr, nullptr, pointers.data(), environ) != 0)
+                throw Sweep::BadConfig(string("Cannot start ") + runner);
+            children.push_back(child);
+        }
+
+        bool failed = false;
+        for(auto child: children) {
+            int status;
+            waitpid(child, &status, 0);
+            if(!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                failed = true;
+        }
+        if(failed)
+            throw Sweep::BadConfig(string("A shard failed, launch again to resume it"));
+
+        auto merged = Sweep::merge_logs(logs);
+        auto points = vector<Sweep::SweepPoint>();
+        auto tallies = vector<Sweep::Tally>();
+        for(auto& entry: merged) {
+            points.push_back(entry.first);
+            tallies.push_back(entry.second);
+        }
+        Sweep::write_results(config.output, points, tallies, vector<string>(points.size(), "fixed"), config.confidence);
+        for(int k = 0; k < (int)points.size(); k++)
+            cout << points[k].to_string() << " | shots = " << tallies[k].shots << ", p_L = " << tallies[k].rate() << endl;
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
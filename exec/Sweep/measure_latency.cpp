@@ -0,0 +1,54 @@
+#include "sweep.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    auto arguments = vector<string>();
+    auto options = vector<pair<string, string>>();
+    for(int n = 1; n < argc; n++) {
+        string argument = argv[n];
+        if(argument.rfind("--", 0) == 0 && n + 1 < argc)
+            options.push_back(make_pair(argument, string(argv[++n])));
+        else
+            arguments.push_back(argument);
+    }
+    if(arguments.empty()) {
+        cerr << "usage: " << argv[0] << " <config> [output] [--shots n] [--warmup n] [--cpu c] [--seed s]" << endl;
+        return 1;
+    }
+    try {
+        auto config = Sweep::SweepConfig::load(arguments[0]);
+        if(arguments.size() >= 2)
+            config.latency_output = arguments[1];
+        for(auto& option: options) {
+            if(option.first == "--shots")
+                config.shots = stoll(option.second);
+            else if(option.first == "--warmup")
+                config.latency_warmup = stoll(option.second);
+            else if(option.first == "--cpu")
+                config.latency_cpu = stoi(option.second);
+            else if(option.first == "--seed")
+                config.seed = stoull(option.second), config.has_seed = true;
+            else
+                throw Sweep::BadConfig(string("Unknown option: ") + option.first);
+        }
+        auto points = config.points();
+        auto reports = Sweep::run_latency(config);
+        Sweep::write_latency(config.latency_path(), points, reports);
+        for(int k = 0; k < (int)points.size(); k++) {
+            auto& report = reports[k];
+            cout << points[k].to_string() << " | us: p50 = " << report.p50 << ", p90 = " << report.p90 << ", p99 = " << report.p99
+                 << ", p99.9 = " << report.p999 << ", max = " << report.max << ", over budget " << report.over_budget << endl;
+        }
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "sweep.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    auto arguments = vector<string>();
+    auto options = vector<pair<string, string>>();
+    for(int n = 1; n < argc; n++) {
+        string argument = argv[n];
+        if(argument.rfind("--", 0) == 0 && n + 1 < argc)
+            options.push_back(make_pair(argument, string(argv[++n])));
+        else
+            arguments.push_back(argument);
+    }
+    if(arguments.size() < 2) {
+        cerr << "usage: " << argv[0] << " <output> <log> [log...] [--log merged_log] [--confidence c]" << endl;
+        return 1;
+    }
+    try {
+        string merged_log = "";
+        // the logs do not record it, the confidence of the run's config is given again
+        double confidence = 0.95;
+        for(auto& option: options) {
+            if(option.first == "--log")
+                merged_log = option.second;
+            else if(option.first == "--confidence")
+                confidence = stod(option.second);
+            else
+                throw Sweep::BadConfig(string("Unknown option: ") + option.first);
+        }
+        if(confidence <= 0 || confidence >= 1)
+            throw Sweep::BadConfig(string("--confidence should be in (0, 1)"));
+        auto paths = vector<string>(arguments.begin() + 1, arguments.end());
+        // a merged log is again a valid input, so merges can be chained in any grouping
+        if(!merged_log.empty())
+            Sweep::SweepLog::write_runs(merged_log, Sweep::merge_runs(paths));
+        auto merged = Sweep::merge_logs(paths);
+        auto points = vector<Sweep::SweepPoint>();
+        auto tallies = vector<Sweep::Tally>();
+        for(auto& entry: merged) {
+            points.push_back(entry.first);
+            tallies.push_back(entry.second);
+        }
+        Sweep::write_results(arguments[0], points, tallies, vector<string>(points.size(), "merged"), confidence);
+        for(int k = 0; k < (int)points.size(); k++)
+            cout << points[k].to_string() << " | shots = " << tallies[k].shots << ", p_L = " << tallies[k].rate() << endl;
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
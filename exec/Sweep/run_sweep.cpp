@@ -0,0 +1,74 @@
+#include "sweep.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    auto arguments = vector<string>();
+    auto options = vector<pair<string, string>>();
+    for(int n = 1; n < argc; n++) {
+        string argument = argv[n];
+        if(argument.rfind("--", 0) == 0 && n + 1 < argc)
+            options.push_back(make_pair(argument, string(argv[++n])));
+        else
+            arguments.push_back(argument);
+    }
+    if(arguments.empty()) {
+        cerr << "usage: " << argv[0] << " <config> [output] [--shard i/N] [--threads n] [--seed s]" << endl;
+        return 1;
+    }
+    try {
+        auto config = Sweep::SweepConfig::load(arguments[0]);
+        if(arguments.size() >= 2)
+            config.output = arguments[1];
+        for(auto& option: options) {
+            if(option.first == "--shard")
+                config.set_shard(option.second);
+            else if(option.first == "--threads")
+                config.num_thread = stoi(option.second);
+            else if(option.first == "--seed")
+                config.seed = stoull(option.second), config.has_seed = true;
+            else
+                throw Sweep::BadConfig(string("Unknown option: ") + option.first);
+        }
+        if(config.estimator != "direct") {
+            auto points = config.points();
+            auto estimates = Sweep::run_rare_event(config);
+            Sweep::write_rare_event_results(config.output, points, estimates, config.confidence);
+            for(int k = 0; k < (int)points.size(); k++) {
+                cout << points[k].to_string() << " | " << estimates[k].method << ", p_L = " << estimates[k].p_L
+                     << " +- " << estimates[k].std_error << endl;
+                for(int j = 0; j < (int)estimates[k].ratios.size(); j++)
+                    cout << "    p_eff " << estimates[k].ladder[j] << " -> " << estimates[k].ladder[j + 1] << ": ratio " << estimates[k].ratios[j] << endl;
+            }
+            return 0;
+        }
+        auto engine = Sweep::SweepEngine(config);
+        engine.run();
+        if(config.shard_count > 1) {
+            // the tallies of a shard only mean something once merged
+            cout << "shard " << config.shard_index << "/" << config.shard_count << " logged to " << config.shard_log() << endl;
+            return 0;
+        }
+        engine.write_results();
+        if(ErrorDynamics::Util::Instrument::enabled)
+            engine.write_stats();
+
+        auto& points = engine.get_points();
+        auto& tallies = engine.get_tallies();
+        for(int k = 0; k < (int)points.size(); k++) {
+            auto interval = engine.get_interval(k);
+            cout << points[k].to_string() << " | shots = " << tallies[k].shots << ", p_L = " << tallies[k].rate()
+                 << " [" << interval.first << ", " << interval.second << "] " << engine.get_status()[k] << endl;
+        }
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
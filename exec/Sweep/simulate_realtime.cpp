@@ -0,0 +1,60 @@
+#include "sweep.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+int main(int argc, char** argv) {
+    auto arguments = vector<string>();
+    auto options = vector<pair<string, string>>();
+    for(int n = 1; n < argc; n++) {
+        string argument = argv[n];
+        if(argument.rfind("--", 0) == 0 && n + 1 < argc)
+            options.push_back(make_pair(argument, string(argv[++n])));
+        else
+            arguments.push_back(argument);
+    }
+    if(arguments.empty()) {
+        cerr << "usage: " << argv[0] << " <config> [output] [--shots n] [--cycle us] [--threads n] [--search 0|1] [--seed s]" << endl;
+        return 1;
+    }
+    try {
+        auto config = Sweep::SweepConfig::load(arguments[0]);
+        if(arguments.size() >= 2)
+            config.realtime_output = arguments[1];
+        for(auto& option: options) {
+            if(option.first == "--shots")
+                config.shots = stoll(option.second);
+            else if(option.first == "--cycle")
+                config.realtime_cycle = stod(option.second);
+            else if(option.first == "--threads")
+                config.realtime_threads = stoi(option.second);
+            else if(option.first == "--search")
+                config.realtime_search = (stoi(option.second) != 0);
+            else if(option.first == "--seed")
+                config.seed = stoull(option.second), config.has_seed = true;
+            else
+                throw Sweep::BadConfig(string("Unknown option: ") + option.first);
+        }
+        auto points = config.points();
+        auto reports = Sweep::run_realtime(config);
+        Sweep::write_realtime(config.realtime_path(), points, reports);
+        for(int k = 0; k < (int)points.size(); k++) {
+            auto& report = reports[k];
+            cout << points[k].to_string() << " | cycle " << report.cycle << " us: " << (report.keeps_up ? "keeps up" : "falls behind")
+                 << ", dropped " << report.dropped << "/" << report.blocks << ", late " << report.late << ", max backlog " << report.max_backlog
+                 << " rounds, utilisation " << report.utilisation;
+            if(report.producer_late > 0)
+                cout << " (the producer was late for " << report.producer_late << " rounds)";
+            cout << endl;
+        }
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -4,6 +4,7 @@
 #include <pybind11/embed.h>
 #include <string>
 #include <filesystem>
+#include <iostream>
 
 #define TEST_SAMPLE_NUM 1000000
 #define TRAIN_SAMPLE_NUM 500000
@@ -33,12 +34,21 @@ int main() {
         std::make_shared<Err::ErrorModel::IIDError>(p / 3, p / 3, p / 3, 0)
     );
 
+    // the repeated and the trivial shots are folded into weighted rows
+    auto train_data = Dc::ML::ShotCompressor(code->get_shape(), 1);
     for(int _ = 0; _ < TRAIN_SAMPLE_NUM / INSERT_BATCH_SIZE; _++) {
-        ml_decoder.add_train_data(ml_decoder.to_pyarray(ml_decoder.generate_batch(code, INSERT_BATCH_SIZE, 1)));
+        train_data.generate(code, INSERT_BATCH_SIZE);
     }
+    ml_decoder.add_train_data(train_data);
+    std::cout << "train: " << train_data.get_shots() << " shots, " << train_data.get_trivial() << " trivial, "
+              << train_data.get_distinct() << " distinct" << std::endl;
+    train_data.clear();
+
+    auto valid_data = Dc::ML::ShotCompressor(code->get_shape(), 1);
     for(int _ = 0; _ < VALID_SAMPLE_NUM / INSERT_BATCH_SIZE; _++) {
-        ml_decoder.add_valid_data(ml_decoder.to_pyarray(ml_decoder.generate_batch(code, INSERT_BATCH_SIZE, 1)));
+        valid_data.generate(code, INSERT_BATCH_SIZE);
     }
+    ml_decoder.add_valid_data(valid_data);
     ml_decoder.init();
     ml_decoder.set_path(data_path);
     ml_decoder.set_name(get_name(d, p));
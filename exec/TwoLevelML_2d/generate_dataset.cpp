@@ -0,0 +1,138 @@
+#include "sweep.hpp"
+
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+namespace Err = ErrorDynamics;
+
+// the splits of TwoLevelML_error_rate_2d
+const vector<pair<string, long long>> default_splits = {
+    {"train", 500000}, {"valid", 200000}, {"test", 1000000}
+};
+
+void write_split(string path, int split, long long shots, const Sweep::SweepPoint& point, unsigned long long seed, int chunk, int threads) {
+    auto header = Err::ShotFileHeader();
+    header.x = header.y = point.d;
+    header.rounds = point.rounds;
+    header.chunk_shots = chunk;
+    header.seed = seed;
+    header.p = point.p;
+    header.noise = point.noise;
+    auto writer = Err::ShotFileWriter(path, header);
+    long long chunks = (shots + chunk - 1) / chunk;
+    // an exception cannot leave the parallel region: the first one is kept, the chunks after it are skipped
+    std::exception_ptr error = nullptr;
+    std::atomic<bool> failed(false);
+    // every chunk has its own random stream: the file does not depend on the number of threads
+    #pragma omp parallel for ordered schedule(dynamic, 1) num_threads(threads)
+    for(long long c = 0; c < chunks; c++) {
+        auto datas = vector<Err::PlanarData>();
+        std::exception_ptr local = nullptr;
+        if(!failed) {
+            try {
+                auto error_model = Sweep::make_error_model(point);
+                error_model->seed(Sweep::derive_seed(seed, split, c));
+                auto code = Err::PlanarSurfaceCode(point.d, error_model);
+                for(long long n = c * chunk; n < min(shots, (c + 1) * chunk); n++) {
+                    code.step(point.rounds);
+                    datas.push_back(code.get_data());
+                    code.reset();
+                }
+            }
+            catch(...) {
+                local = std::current_exception();
+            }
+        }
+        // every iteration passes the ordered region once, in order, so error is only touched there
+        #pragma omp ordered
+        {
+            if(!error && local)
+                error = local;
+            if(!error) {
+                try {
+                    for(auto& data: datas)
+                        writer.append(data);
+                }
+                catch(...) {
+                    error = std::current_exception();
+                }
+            }
+            if(error)
+                failed = true;
+        }
+    }
+    // a write error, e.g. a full disk: the file ends at the last complete chunk
+    if(error)
+        std::rethrow_exception(error);
+    writer.close();
+}
+
+int main(int argc, char** argv) {
+    auto arguments = vector<string>();
+    auto options = vector<pair<string, string>>();
+    for(int n = 1; n < argc; n++) {
+        string argument = argv[n];
+        if(argument.rfind("--", 0) == 0 && n + 1 < argc)
+            options.push_back(make_pair(argument, string(argv[++n])));
+        else
+            arguments.push_back(argument);
+    }
+    if(arguments.size() < 3) {
+        cerr << "usage: " << argv[0] << " <output dir> <d> <p> [--noise iid_balanced] [--rounds 1] [--seed s] "
+             << "[--train n] [--valid n] [--test n] [--chunk n] [--threads n]" << endl;
+        return 1;
+    }
+    try {
+        auto point = Sweep::SweepPoint();
+        point.d = stoi(arguments[1]);
+        point.p = point.p_eff = stod(arguments[2]);
+        point.noise = "iid_balanced";
+        point.rounds = 1;
+        unsigned long long seed = 0;
+        int chunk = 4096, threads = 1;
+        auto splits = default_splits;
+        for(auto& option: options) {
+            if(option.first == "--noise")
+                point.noise = option.second;
+            else if(option.first == "--rounds")
+                point.rounds = stoi(option.second);
+            else if(option.first == "--seed")
+                seed = stoull(option.second);
+            else if(option.first == "--chunk")
+                chunk = stoi(option.second);
+            else if(option.first == "--threads")
+                threads = stoi(option.second);
+            else {
+                bool found = false;
+                for(auto& split: splits) {
+                    if(option.first == "--" + split.first)
+                        split.second = stoll(option.second), found = true;
+                }
+                if(!found)
+                    throw Sweep::BadConfig(string("Unknown option: ") + option.first);
+            }
+        }
+        if(chunk <= 0 || point.rounds <= 0)
+            throw Sweep::BadConfig(string("The chunk size and the number of rounds should be positive"));
+        // an unknown noise model throws here rather than inside the parallel region
+        Sweep::make_error_model(point);
+        std::filesystem::create_directories(arguments[0]);
+        for(int s = 0; s < (int)splits.size(); s++) {
+            auto path = (std::filesystem::path(arguments[0]) / (splits[s].first + ".shots")).string();
+            write_split(path, s, splits[s].second, point, seed, chunk, threads);
+            cout << path << ": " << splits[s].second << " shots, d = " << point.d << ", p = " << point.p
+                 << ", noise = " << point.noise << ", rounds = " << point.rounds << endl;
+        }
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
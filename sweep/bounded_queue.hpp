@@ -0,0 +1,78 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace Sweep {
+
+template<typename T>
+class BoundedQueue {
+    /*
+    A FIFO of at most capacity items shared by any number of producers and
+    consumers. try_push never waits, so a producer with a deadline can drop
+    what does not fit; pop waits until an item arrives or the queue is closed,
+    try_pop does not wait, for consumers which poll.
+    */
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::deque<T> items;
+    size_t capacity;
+    bool closed;
+
+    public:
+    BoundedQueue() = delete;
+    inline BoundedQueue(size_t _capacity) : capacity(_capacity), closed(false) {}
+
+    // false if the queue is full, the size after the push otherwise in size
+    inline bool try_push(T item, size_t& size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(items.size() >= capacity)
+                return false;
+            items.push_back(std::move(item));
+            size = items.size();
+        }
+        not_empty.notify_one();
+        return true;
+    }
+
+    // false once the queue is closed and empty
+    inline bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this]() { return !items.empty() || closed; });
+        if(items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    // false if the queue is empty, _closed tells whether it will stay so
+    inline bool try_pop(T& item, bool& _closed) {
+        std::lock_guard<std::mutex> lock(mutex);
+        _closed = closed;
+        if(items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    // no more pushes, the consumers drain what is left
+    inline void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+        }
+        not_empty.notify_all();
+    }
+
+    inline size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+};
+
+}
@@ -0,0 +1,18 @@
+#include "exception.hpp"
+
+namespace Sweep {
+
+BadConfig::BadConfig(std::string _info){
+    info = _info;
+}
+
+BadConfig& BadConfig::operator=(const BadConfig& other){
+    info = other.info;
+    return *this;
+}
+
+const char* BadConfig::what() const noexcept{
+    return info.c_str();
+}
+
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <exception>
+#include <string>
+
+namespace Sweep {
+
+class BadConfig: public std::exception{
+    private:
+    std::string info;
+
+    public:
+    BadConfig(std::string _info);
+    BadConfig& operator=(const BadConfig& other);
+    const char* what() const noexcept;
+};
+
+}
@@ -0,0 +1,131 @@
+#include "latency.hpp"
+#include "exception.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if(sorted.empty())
+        return 0;
+    long long rank = (long long)std::ceil(q * sorted.size());
+    return sorted[std::min(std::max(rank, 1ll), (long long)sorted.size()) - 1];
+}
+
+void pin_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if(cpu < 0 || cpu >= CPU_SETSIZE || pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+        throw BadConfig(std::string("Cannot pin the thread to core ") + std::to_string(cpu));
+#else
+    throw BadConfig(std::string("Pinning a thread is only supported on Linux"));
+#endif
+}
+
+unsigned long long latency_seed(unsigned long long seed, const SweepPoint& point) {
+    unsigned long long p_bits;
+    std::memcpy(&p_bits, &point.p_eff, sizeof(p_bits));
+    // FNV-1a of the noise model
+    unsigned long long noise_hash = 0xcbf29ce484222325ull;
+    for(char c: point.noise)
+        noise_hash = (noise_hash ^ (unsigned char)c) * 0x100000001b3ull;
+    return derive_seed(derive_seed(seed, point.d, p_bits), point.rounds, noise_hash);
+}
+
+LatencyReport measure_latency(const SweepPoint& point, long long decodes, long long warmup, double budget, unsigned long long seed) {
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = LatencyReport();
+    ret.decodes = decodes, ret.warmup = warmup;
+    auto error_model = make_error_model(point);
+    error_model->seed(seed);
+    auto code = Err::PlanarSurfaceCode(point.d, error_model);
+    auto cache = (point.decoder == "mwpm_cached" ? std::make_shared<Dc::Cache::DecodeCache>(1 << 16) : nullptr);
+    auto decoder = make_decoder(point, code.get_shape(), cache);
+
+    // small enough to stay in cache, large enough to keep the simulation out of the way
+    const int chunk_size = 256;
+    auto chunk = std::vector<std::pair<Err::PlanarData, std::shared_ptr<Err::CodeScheme::PlanarErasure>>>();
+    chunk.reserve(chunk_size);
+    auto latency = std::vector<double>();
+    latency.reserve(decodes);
+    for(long long n = 0; n < warmup + decodes; ) {
+        chunk.clear();
+        for(int _ = 0; _ < chunk_size && n + (long long)chunk.size() < warmup + decodes; _++) {
+            code.step(point.rounds);
+            chunk.push_back(std::make_pair(code.get_data(), code.get_erasure()));
+            code.reset();
+        }
+        for(auto& shot: chunk) {
+            auto start = std::chrono::steady_clock::now();
+            auto correction = decode_shot(*decoder, shot.first, shot.second);
+            auto stop = std::chrono::steady_clock::now();
+            if(n++ >= warmup)
+                latency.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+        }
+    }
+
+    std::sort(latency.begin(), latency.end());
+    double sum = 0;
+    long long over = 0;
+    for(auto value: latency) {
+        sum += value;
+        if(value > budget * point.rounds)
+            over++;
+    }
+    if(!latency.empty()) {
+        ret.mean = sum / latency.size();
+        ret.over_budget = (double)over / latency.size();
+        ret.max = latency.back();
+    }
+    ret.p50 = percentile(latency, 0.5);
+    ret.p90 = percentile(latency, 0.9);
+    ret.p99 = percentile(latency, 0.99);
+    ret.p999 = percentile(latency, 0.999);
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ret;
+}
+
+std::vector<LatencyReport> run_latency(const SweepConfig& config) {
+    for(auto& noise: config.noise_list) {
+        if(noise == "circuit")
+            throw BadConfig(std::string("Latency runs step an error model per round, circuit noise has none"));
+    }
+    if(config.latency_cpu >= 0)
+        pin_thread(config.latency_cpu);
+    auto ret = std::vector<LatencyReport>();
+    // one point after the other on one thread: a decode never competes with another one
+    for(auto& point: config.points())
+        ret.push_back(measure_latency(point, config.shots, config.latency_warmup, config.latency_budget, latency_seed(config.seed, point)));
+    return ret;
+}
+
+void write_latency(std::string path, const std::vector<SweepPoint>& points, const std::vector<LatencyReport>& reports) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    file << "d,p,p_eff,noise,decoder,rounds,decodes,warmup,mean_us,p50_us,p90_us,p99_us,p99.9_us,max_us,over_budget,seconds" << std::endl;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        auto& report = reports[k];
+        file << point.d << "," << point.p << "," << point.p_eff << "," << point.noise << "," << point.decoder << "," << point.rounds << ","
+             << report.decodes << "," << report.warmup << "," << report.mean << "," << report.p50 << "," << report.p90 << ","
+             << report.p99 << "," << report.p999 << "," << report.max << "," << report.over_budget << "," << report.seconds << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct LatencyReport {
+    /*
+    The distribution of the wall time of single decodes of one point, in
+    microseconds. The shots are simulated in chunks ahead of the decodes, so
+    only the call of the decoder is timed, with the steady clock.
+    */
+    long long decodes, warmup;
+    double mean, p50, p90, p99, p999, max;
+    // the fraction of the decodes slower than latency_budget times the rounds
+    double over_budget;
+    // the whole measurement, simulation included
+    double seconds;
+
+    inline LatencyReport() : decodes(0), warmup(0), mean(0), p50(0), p90(0), p99(0), p999(0), max(0), over_budget(0), seconds(0) {}
+};
+
+// the q-quantile of sorted values by the nearest rank, so it is always one of the values
+double percentile(const std::vector<double>& sorted, double q);
+
+// pin the calling thread to a core, throws BadConfig if it cannot be done
+void pin_thread(int cpu);
+
+// the stream of shots only depends on the seed, d, p_eff, noise and rounds: the decoders of a grid all see the same shots
+unsigned long long latency_seed(unsigned long long seed, const SweepPoint& point);
+
+// warmup untimed decodes, then decodes timed ones, of the shot stream of the seed
+LatencyReport measure_latency(const SweepPoint& point, long long decodes, long long warmup, double budget, unsigned long long seed);
+
+// "shots" timed decodes of every point of the grid in turn, on the latency_cpu core if one is set
+std::vector<LatencyReport> run_latency(const SweepConfig& config);
+
+// one CSV row per point
+void write_latency(std::string path, const std::vector<SweepPoint>& points, const std::vector<LatencyReport>& reports);
+
+}
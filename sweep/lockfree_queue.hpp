@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace Sweep {
+
+// keeps the indices of the two sides on separate cache lines
+constexpr size_t cache_line = 64;
+
+inline size_t round_up_power_of_two(size_t n) {
+    size_t ret = 1;
+    while(ret < n)
+        ret <<= 1;
+    return ret;
+}
+
+template<typename T>
+class SpscQueue {
+    /*
+    A bounded ring for exactly one producer thread and one consumer thread.
+    Each side owns one index and only reads the other one, so a push or a pop
+    is a load, a store and a release of the own index.
+    */
+    std::unique_ptr<T[]> buffer;
+    size_t mask;
+    alignas(cache_line) std::atomic<size_t> head; // next to pop, written by the consumer
+    alignas(cache_line) std::atomic<size_t> tail; // next to push, written by the producer
+
+    public:
+    SpscQueue() = delete;
+    inline SpscQueue(size_t capacity) : mask(round_up_power_of_two(capacity) - 1), head(0), tail(0) {
+        buffer = std::make_unique<T[]>(mask + 1);
+    }
+
+    inline bool try_push(const T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if(position - head.load(std::memory_order_acquire) > mask)
+            return false;
+        buffer[position & mask] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    inline bool try_pop(T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if(position == tail.load(std::memory_order_acquire))
+            return false;
+        item = buffer[position & mask];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+template<typename T>
+class MpmcQueue {
+    /*
+    Dmitry Vyukov's bounded queue for any number of producers and consumers.
+    Every cell carries a sequence number telling whether it is free for the
+    push of a given turn or full for its pop; a thread claims a position with
+    a compare-and-swap on the shared index and then owns the cell, so there is
+    no lock and no allocation after the construction.
+    */
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+    std::unique_ptr<Cell[]> buffer;
+    size_t mask;
+    alignas(cache_line) std::atomic<size_t> enqueue_position;
+    alignas(cache_line) std::atomic<size_t> dequeue_position;
+
+    public:
+    MpmcQueue() = delete;
+    inline MpmcQueue(size_t capacity) : mask(round_up_power_of_two(capacity < 2 ? 2 : capacity) - 1), enqueue_position(0), dequeue_position(0) {
+        buffer = std::make_unique<Cell[]>(mask + 1);
+        for(size_t n = 0; n <= mask; n++)
+            buffer[n].sequence.store(n, std::memory_order_relaxed);
+    }
+
+    inline bool try_push(const T& item) {
+        size_t position = enqueue_position.load(std::memory_order_relaxed);
+        while(true) {
+            Cell& cell = buffer[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)position;
+            if(difference == 0) {
+                if(enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.data = item;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(difference < 0) {
+                return false; // full
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    inline bool try_pop(T& item) {
+        size_t position = dequeue_position.load(std::memory_order_relaxed);
+        while(true) {
+            Cell& cell = buffer[position & mask];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            auto difference = (std::ptrdiff_t)sequence - (std::ptrdiff_t)(position + 1);
+            if(difference == 0) {
+                if(dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    item = cell.data;
+                    cell.sequence.store(position + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(difference < 0) {
+                return false; // empty
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}
@@ -0,0 +1,188 @@
+#include "pipeline.hpp"
+#include "lockfree_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct ShotBuffer {
+    int task;
+    Err::PlanarData data;
+    std::shared_ptr<Err::CodeScheme::PlanarErasure> erasure;
+    // filled in by the decoder
+    bool failure;
+    long long y_errors, total_errors;
+    double seconds;
+};
+
+// spin on a full or an empty queue, yielding so that an oversubscribed machine still makes progress; false once stopped
+template<typename Operation>
+bool spin_until(Operation operation, const std::atomic<bool>& stopped) {
+    while(!operation()) {
+        if(stopped.load(std::memory_order_relaxed))
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+}
+
+ShotPipeline::ShotPipeline(
+    const SweepConfig& _config,
+    const std::vector<SweepPoint>& _points,
+    const std::vector<std::shared_ptr<Dc::Cache::DecodeCache>>& _caches
+) : config(_config), points(_points), caches(_caches) {}
+
+void ShotPipeline::run(const std::vector<std::pair<int, long long>>& tasks, const std::function<void(int, long long, const Tally&)>& on_batch) {
+    auto batch_shots = [this](long long batch) {
+        return (int)std::min<long long>(config.batch_size, config.shots - batch * config.batch_size);
+    };
+    long long total_shots = 0;
+    for(auto& task: tasks)
+        total_shots += batch_shots(task.second);
+
+    int num_buffer = (int)round_up_power_of_two(config.pipeline_buffers);
+    auto buffers = std::vector<ShotBuffer>(num_buffer);
+    auto free_buffers = MpmcQueue<int>(num_buffer);
+    auto full_buffers = MpmcQueue<int>(num_buffer);
+    auto done_buffers = std::vector<std::unique_ptr<SpscQueue<int>>>();
+    for(int n = 0; n < num_buffer; n++)
+        free_buffers.try_push(n);
+    for(int n = 0; n < config.pipeline_decoders; n++)
+        done_buffers.push_back(std::make_unique<SpscQueue<int>>(num_buffer));
+
+    // the first exception of any stage stops all of them, and is rethrown once they are joined
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    std::atomic<bool> stopped(false);
+    auto fail = [&]() {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if(!error)
+            error = std::current_exception();
+        stopped = true;
+    };
+
+    std::atomic<long long> next_task(0);
+    std::atomic<int> running_generators(config.pipeline_generators);
+    auto workers = std::vector<std::thread>();
+    for(int n = 0; n < config.pipeline_generators; n++) {
+        workers.push_back(std::thread([&]() {
+            try {
+                for(long long t = next_task++; t < (long long)tasks.size() && !stopped; t = next_task++) {
+                    auto& point = points[tasks[t].first];
+                    long long batch = tasks[t].second;
+                    auto error_model = make_error_model(point);
+                    error_model->seed(derive_seed(config.seed, tasks[t].first, batch));
+                    auto code = Err::PlanarSurfaceCode(point.d, error_model);
+                    for(int _ = 0; _ < batch_shots(batch); _++) {
+                        int index;
+                        if(!spin_until([&]() { return free_buffers.try_pop(index); }, stopped))
+                            break;
+                        auto begin = Clock::now();
+                        auto& buffer = buffers[index];
+                        code.step(point.rounds);
+                        buffer.task = (int)t;
+                        buffer.data = code.get_data();
+                        buffer.erasure = code.get_erasure();
+                        code.reset();
+                        buffer.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+                        if(!spin_until([&]() { return full_buffers.try_push(index); }, stopped))
+                            break;
+                    }
+                }
+            }
+            catch(...) {
+                fail();
+            }
+            running_generators.fetch_sub(1, std::memory_order_release);
+        }));
+    }
+    for(int n = 0; n < config.pipeline_decoders; n++) {
+        workers.push_back(std::thread([&, n]() {
+            // the decoders keep state between calls, every thread owns one per point
+            auto decoders = std::vector<std::shared_ptr<Dc::DecoderBase>>(points.size());
+            auto& done = *done_buffers[n];
+            try {
+                while(!stopped) {
+                    bool finished = (running_generators.load(std::memory_order_acquire) == 0);
+                    int index;
+                    if(!full_buffers.try_pop(index)) {
+                        // every push happened before the generators finished, so the queue stays empty
+                        if(finished)
+                            break;
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    auto begin = Clock::now();
+                    auto& buffer = buffers[index];
+                    int k = tasks[buffer.task].first;
+                    if(!decoders[k])
+                        decoders[k] = make_decoder(points[k], Err::CodeScheme::PlanarShape(points[k].d, points[k].d), caches[k]);
+                    auto correction = decode_shot(*decoders[k], buffer.data, buffer.erasure);
+                    auto stat = buffer.data.second->count_errors();
+                    auto corrected = buffer.data.second * correction;
+                    buffer.failure = !corrected->is_correct();
+                    buffer.y_errors = stat[2];
+                    buffer.total_errors = stat[1] + stat[2] + stat[3];
+                    buffer.seconds += std::chrono::duration<double>(Clock::now() - begin).count();
+                    if(!spin_until([&]() { return done.try_push(index); }, stopped))
+                        break;
+                }
+            }
+            catch(...) {
+                fail();
+            }
+        }));
+    }
+
+    // the aggregator: the batches complete in any order
+    auto tallies = std::vector<Tally>(tasks.size());
+    try {
+        for(long long received = 0; received < total_shots && !stopped; ) {
+            bool idle = true;
+            for(auto& done: done_buffers) {
+                int index;
+                while(done->try_pop(index)) {
+                    idle = false;
+                    received++;
+                    auto& buffer = buffers[index];
+                    int t = buffer.task;
+                    auto& tally = tallies[t];
+                    tally.shots++;
+                    tally.seconds += buffer.seconds;
+                    if(buffer.failure) {
+                        tally.failures++;
+                        tally.y_errors += buffer.y_errors;
+                        tally.total_errors += buffer.total_errors;
+                    }
+                    spin_until([&]() { return free_buffers.try_push(index); }, stopped);
+                    if(tally.shots == batch_shots(tasks[t].second))
+                        on_batch(tasks[t].first, tasks[t].second, tally);
+                }
+            }
+            if(idle)
+                std::this_thread::yield();
+        }
+    }
+    catch(...) {
+        fail();
+    }
+    for(auto& worker: workers)
+        worker.join();
+    if(error)
+        std::rethrow_exception(error);
+}
+
+}
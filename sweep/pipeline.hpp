@@ -0,0 +1,45 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Sweep {
+
+class ShotPipeline {
+    /*
+    Runs batches as a pipeline instead of one thread per batch:
+
+        generators --MPMC--> decoders --SPSC per decoder--> aggregator
+             ^                                                   |
+             +------------------- free buffers (MPMC) -----------+
+
+    Generator threads take whole batches and simulate their shots in order
+    from derive_seed(seed, point, batch), so every batch sees the same shots
+    as run_batch. Each shot goes into a buffer of a fixed pool, and only the
+    buffer index travels through the lock-free queues. Decoder threads decode
+    and check the shots, and the calling thread adds them up and hands every
+    completed batch to on_batch. The simulator and the decoders then no longer
+    share a core's caches, and each stage gets as many threads as it needs.
+    The first exception of any stage stops the others and is rethrown by run.
+    */
+    const SweepConfig& config;
+    const std::vector<SweepPoint>& points;
+    const std::vector<std::shared_ptr<Decoder::Cache::DecodeCache>>& caches;
+
+    public:
+    ShotPipeline() = delete;
+    ShotPipeline(
+        const SweepConfig& _config,
+        const std::vector<SweepPoint>& _points,
+        const std::vector<std::shared_ptr<Decoder::Cache::DecodeCache>>& _caches
+    );
+
+    // run the (point, batch) tasks, on_batch(point, batch, tally) is called by the calling thread
+    void run(const std::vector<std::pair<int, long long>>& tasks, const std::function<void(int, long long, const Tally&)>& on_batch);
+};
+
+}
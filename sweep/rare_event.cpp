@@ -0,0 +1,315 @@
+#include "rare_event.hpp"
+#include "exception.hpp"
+#include "statistics.hpp"
+#include "stratified.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <omp.h>
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+// probabilities of I, X, Y, Z on a data qubit
+static std::array<double, 4> pauli_rates(const SweepPoint& point, double p_eff) {
+    if(point.noise == "iid_balanced")
+        return std::array<double, 4>({1 - p_eff, p_eff / 3, p_eff / 3, p_eff / 3});
+    if(point.noise == "iid_independent") {
+        double p_independent = sqrt(1 + p_eff) - 1;
+        return std::array<double, 4>({1 - p_eff, p_independent, pow(p_independent, 2.0), p_independent});
+    }
+    throw BadConfig(std::string("Rare-event estimators need iid noise, not ") + point.noise);
+}
+
+static void check_decoder(const SweepPoint& point) {
+    if(point.decoder != "mwpm" && point.decoder != "mwpm_cached")
+        throw BadConfig(std::string("Rare-event estimators need a matching decoder, not ") + point.decoder);
+}
+
+double importance_scale(const SweepPoint& point) {
+    auto rates = pauli_rates(point, point.p_eff);
+    double p_data = 1 - rates[0];
+    double pm = (point.rounds > 1 ? point.p_eff * 2 / 3 : 0);
+    double sites = (double)point.d * point.d;
+    double data = (sites + 1) / 2;
+    double faults = point.rounds * (data * p_data + (sites - data) * pm);
+    // the smallest logical error of the code of distance (d + 1) / 2
+    double wanted = ((point.d + 1) / 2 + 1) / 2;
+    double scale = std::min(wanted / faults, 0.5 / std::max(p_data, pm));
+    return std::max(1.0, scale);
+}
+
+WeightedTally run_importance_batch(const SweepPoint& point, double scale, int batch_size, unsigned long long seed) {
+    check_decoder(point);
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = WeightedTally();
+    auto rates = pauli_rates(point, point.p_eff);
+    bool measurement_error = point.rounds > 1;
+    double pm = (measurement_error ? point.p_eff * 2 / 3 : 0);
+    auto error_model = std::make_shared<Err::ErrorModel::BiasedIIDError>(rates[1], rates[2], rates[3], pm, scale);
+    error_model->seed(seed);
+    auto code = Err::PlanarSurfaceCode(point.d, error_model);
+    auto decoder = Dc::Matching::StandardMWPMDecoder(point.p_eff, point.p_eff, point.p_eff, pm, measurement_error, code.get_shape());
+
+    for(int _ = 0; _ < batch_size; _++) {
+        error_model->reset_log_weight();
+        code.step(point.rounds);
+        auto data = code.get_data();
+        auto correction = decoder(data);
+        auto corrected = data.second * correction;
+        ret.shots++;
+        if(!corrected->is_correct()) {
+            double weight = std::exp(error_model->get_log_weight());
+            ret.failures++;
+            ret.sum_weight += weight;
+            ret.sum_square_weight += weight * weight;
+        }
+        code.reset();
+    }
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ret;
+}
+
+RareEventEstimate importance_sampling(const SweepConfig& config, int k, const SweepPoint& point) {
+    // what run_importance_batch would throw, checked here: an exception cannot leave the parallel region
+    check_decoder(point);
+    auto rates = pauli_rates(point, point.p_eff);
+    double scale = (config.is_scale > 0 ? config.is_scale : importance_scale(point));
+    double pm = (point.rounds > 1 ? point.p_eff * 2 / 3 : 0);
+    if((rates[1] + rates[2] + rates[3]) * scale > 1 || pm * scale > 1)
+        throw BadConfig(std::string("\"is_scale\" takes the error rates of ") + point.to_string() + " above 1");
+    long long batches = (config.shots + config.batch_size - 1) / config.batch_size;
+    auto total = WeightedTally();
+
+    std::exception_ptr error = nullptr;
+    #pragma omp parallel num_threads(config.num_thread)
+    {
+        auto local = WeightedTally();
+        #pragma omp for schedule(dynamic, 1) nowait
+        for(long long b = 0; b < batches; b++) {
+            int shots = (int)std::min<long long>(config.batch_size, config.shots - b * config.batch_size);
+            try {
+                local += run_importance_batch(point, scale, shots, derive_seed(config.seed, k, b));
+            }
+            catch(...) {
+                #pragma omp critical
+                error = std::current_exception();
+            }
+        }
+        #pragma omp critical
+        total += local;
+    }
+    if(error)
+        std::rethrow_exception(error);
+
+    auto ret = RareEventEstimate();
+    ret.method = "importance";
+    double n = (double)total.shots;
+    ret.p_L = total.sum_weight / n;
+    double variance = std::max(0.0, total.sum_square_weight / n - ret.p_L * ret.p_L) * n / std::max(1.0, n - 1);
+    ret.std_error = std::sqrt(variance / n);
+    ret.shots = total.shots, ret.failures = total.failures;
+    ret.seconds = total.seconds;
+    return ret;
+}
+
+RareEventEstimate splitting(const SweepConfig& config, int k, const SweepPoint& point) {
+    check_decoder(point);
+    if(point.rounds > 1)
+        throw BadConfig(std::string("Splitting only supports perfect measurements"));
+    if(config.splitting_start <= 0)
+        throw BadConfig(std::string("Splitting needs \"splitting_start\""));
+    double p_top = 1.0 - pow(1.0 - config.splitting_start, config.p_exponent);
+    if(p_top < point.p_eff)
+        throw BadConfig(std::string("\"splitting_start\" should be above every p of the grid"));
+
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = RareEventEstimate();
+    ret.method = "splitting";
+
+    // direct sampling at the top of the ladder, keeping one failure to start the chains from
+    auto top_rates = pauli_rates(point, p_top);
+    auto top_model = std::make_shared<Err::ErrorModel::IIDError>(top_rates[1], top_rates[2], top_rates[3], 0);
+    top_model->seed(derive_seed(config.seed, k, 0));
+    auto top_code = Err::PlanarSurfaceCode(point.d, top_model);
+    auto shape = top_code.get_shape();
+    // the matching weights do not depend on p, so the same decoder serves every rung
+    auto decoder = Dc::Matching::StandardMWPMDecoder(point.p_eff, point.p_eff, point.p_eff, 0, false, shape);
+    std::shared_ptr<Err::CodeScheme::PlanarError> state;
+    for(long long _ = 0; _ < config.shots; _++) {
+        top_code.step();
+        auto data = top_code.get_data();
+        auto corrected = data.second * decoder(data);
+        ret.shots++;
+        if(!corrected->is_correct()) {
+            ret.failures++;
+            if(!state)
+                state = data.second;
+        }
+        top_code.reset();
+    }
+    if(ret.failures == 0)
+        throw BadConfig(std::string("No failure at \"splitting_start\" for ") + point.to_string() + ", raise it");
+    double p_start = (double)ret.failures / (double)ret.shots;
+    ret.p_L = p_start;
+    double relative_variance = (1 - p_start) / (p_start * (double)ret.shots);
+
+    auto code = Err::PlanarSurfaceCode(point.d, std::make_shared<Err::ErrorModel::IIDError>(0, 0, 0, 0));
+    auto no_syndrome_error = std::make_shared<Err::CodeScheme::PlanarSyndrome>(shape.x(), shape.y());
+    auto fails = [&]() {
+        code.reset();
+        code.manual_step(state, no_syndrome_error);
+        auto data = code.get_data();
+        return !(data.second * decoder(data))->is_correct();
+    };
+
+    auto sites = std::vector<Err::CodeScheme::PlanarIndex>();
+    auto count = std::array<long long, 4>({0, 0, 0, 0});
+    for(int i = 0; i < shape.x(); i++) {
+        for(int j = i % 2; j < shape.y(); j += 2) {
+            sites.push_back(Err::CodeScheme::PlanarIndex(i, j));
+            count[(int)state->get_error(sites.back())]++;
+        }
+    }
+
+    std::mt19937_64 rng_engine(derive_seed(config.seed, k, 1));
+    std::uniform_int_distribution<int> site_distribution(0, (int)sites.size() - 1);
+    std::uniform_int_distribution<int> pauli_distribution(1, 3);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    const int num_batch = 20;
+    long long steps = config.splitting_steps;
+    long long burn_in = steps / 10;
+
+    double mean_weight = (double)(count[1] + count[2] + count[3]);
+    double p = p_top;
+    ret.ladder.push_back(p);
+    while(p > point.p_eff) {
+        // Bravyi and Vargo: the ratio stays of order one when log(p_j / p_{j+1}) ~ 1 / sqrt(weight)
+        double p_next = std::max(point.p_eff, p * pow(2.0, -1.0 / std::sqrt(std::max(1.0, mean_weight))));
+        if(p_next > point.p_eff && p_next < point.p_eff * 1.01)
+            p_next = point.p_eff;
+        auto rates = pauli_rates(point, p);
+        auto next_rates = pauli_rates(point, p_next);
+        auto log_step = std::array<double, 4>();
+        for(int e = 0; e < 4; e++)
+            log_step[e] = std::log(next_rates[e] / rates[e]);
+
+        auto batch_sum = std::vector<double>(num_batch, 0);
+        auto batch_count = std::vector<long long>(num_batch, 0);
+        double weight_sum = 0;
+        for(long long s = 0; s < burn_in + steps; s++) {
+            // Metropolis on P_j restricted to the failing errors
+            auto& site = sites[site_distribution(rng_engine)];
+            int old_pauli = (int)state->get_error(site);
+            int new_pauli = (old_pauli + pauli_distribution(rng_engine)) % 4;
+            if(uniform(rng_engine) < rates[new_pauli] / rates[old_pauli]) {
+                state->set_error(site, (Err::Util::Pauli)new_pauli);
+                if(fails()) {
+                    count[old_pauli]--, count[new_pauli]++;
+                } else {
+                    state->set_error(site, (Err::Util::Pauli)old_pauli);
+                }
+            }
+            if(s < burn_in)
+                continue;
+            double log_ratio = 0;
+            for(int e = 0; e < 4; e++)
+                log_ratio += count[e] * log_step[e];
+            int b = (int)((s - burn_in) * num_batch / steps);
+            batch_sum[b] += std::exp(log_ratio);
+            batch_count[b]++;
+            weight_sum += (double)(count[1] + count[2] + count[3]);
+        }
+        ret.steps += burn_in + steps;
+
+        double ratio = 0;
+        for(int b = 0; b < num_batch; b++)
+            ratio += batch_sum[b];
+        ratio /= (double)steps;
+        // batch means absorb the autocorrelation of the chain
+        double variance = 0;
+        for(int b = 0; b < num_batch; b++) {
+            double mean = batch_sum[b] / std::max(1ll, batch_count[b]);
+            variance += (mean - ratio) * (mean - ratio);
+        }
+        variance /= (double)num_batch * (num_batch - 1);
+
+        ret.p_L *= ratio;
+        relative_variance += variance / (ratio * ratio);
+        ret.ladder.push_back(p_next);
+        ret.ratios.push_back(ratio);
+        mean_weight = weight_sum / (double)steps;
+        p = p_next;
+    }
+    ret.std_error = ret.p_L * std::sqrt(relative_variance);
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ret;
+}
+
+std::vector<RareEventEstimate> run_rare_event(const SweepConfig& config) {
+    auto points = config.points();
+    auto ret = std::vector<RareEventEstimate>(points.size());
+    if(config.estimator == "importance") {
+        // the shots of a point are spread over the threads
+        for(int k = 0; k < (int)points.size(); k++)
+            ret[k] = importance_sampling(config, k, points[k]);
+    } else if(config.estimator == "splitting") {
+        // a chain is sequential, the points are spread over the threads
+        std::exception_ptr error = nullptr;
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(config.num_thread)
+        for(int k = 0; k < (int)points.size(); k++) {
+            try {
+                ret[k] = splitting(config, k, points[k]);
+            }
+            catch(...) {
+                #pragma omp critical
+                error = std::current_exception();
+            }
+        }
+        if(error)
+            std::rethrow_exception(error);
+    } else if(config.estimator == "stratified") {
+        ret = run_stratified(config);
+    } else {
+        throw BadConfig(std::string("Not a rare-event estimator: ") + config.estimator);
+    }
+    return ret;
+}
+
+void write_rare_event_results(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<RareEventEstimate>& estimates,
+    double confidence
+) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    double z = normal_quantile(0.5 + confidence / 2);
+    std::ofstream file(path);
+    file << "d,p,p_eff,noise,decoder,rounds,estimator,shots,failures,steps,p_L,std_error,ci_low,ci_high,seconds" << std::endl;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        auto& estimate = estimates[k];
+        double low, high;
+        if(estimate.method == "splitting" && estimate.p_L > 0) {
+            // a product of ratios is closer to log-normal
+            double spread = std::exp(z * estimate.std_error / estimate.p_L);
+            low = estimate.p_L / spread, high = estimate.p_L * spread;
+        } else {
+            low = std::max(0.0, estimate.p_L - z * estimate.std_error), high = estimate.p_L + z * estimate.std_error;
+        }
+        high += estimate.tail;
+        file << point.d << "," << point.p << "," << point.p_eff << "," << point.noise << "," << point.decoder << "," << point.rounds << ","
+             << estimate.method << "," << estimate.shots << "," << estimate.failures << "," << estimate.steps << ","
+             << estimate.p_L << "," << estimate.std_error << "," << low << "," << high << "," << estimate.seconds << std::endl;
+    }
+}
+
+}
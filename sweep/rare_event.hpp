@@ -0,0 +1,70 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct RareEventEstimate {
+    /*
+    An estimate of p_L far below the reach of direct sampling.
+    importance: shots from the biased model, failures weighted by P(E) / Q(E), unbiased
+    splitting:  consistent as the chains mix, p_L at the top of a ladder of error rates by direct sampling, times
+                p_L(p_{j+1}) / p_L(p_j) for every rung, each one the mean of
+                P_{j+1}(E) / P_j(E) over a Metropolis chain on the failing errors
+    stratified: the binomial mixture of the failure rates at a fixed number of faults,
+                see stratified.hpp
+    */
+    std::string method;
+    double p_L, std_error;
+    // importance: shots and failures of the biased model; splitting: shots, failures of the top rung and chain steps
+    long long shots, failures, steps;
+    double seconds;
+    // splitting only: the error rates p_eff of the rungs, from the top down to the point, and the ratios between them
+    std::vector<double> ladder, ratios;
+    // stratified only: the probability of the unsampled strata, p_L may be larger by up to this
+    double tail;
+
+    inline RareEventEstimate() : p_L(0), std_error(0), shots(0), failures(0), steps(0), seconds(0), tail(0) {}
+};
+
+struct WeightedTally {
+    long long shots, failures;
+    double sum_weight, sum_square_weight;
+    double seconds;
+
+    inline WeightedTally() : shots(0), failures(0), sum_weight(0), sum_square_weight(0), seconds(0) {}
+    inline WeightedTally& operator+=(const WeightedTally& other) {
+        shots += other.shots, failures += other.failures;
+        sum_weight += other.sum_weight, sum_square_weight += other.sum_square_weight;
+        seconds += other.seconds;
+        return *this;
+    }
+};
+
+// the bias which puts the weight of the smallest logical error into an average shot, never below 1
+double importance_scale(const SweepPoint& point);
+
+// batch_size shots of the point from BiasedIIDError, failures weighted by the likelihood ratio
+WeightedTally run_importance_batch(const SweepPoint& point, double scale, int batch_size, unsigned long long seed);
+
+// "shots" shots of point k of the config in parallel batches
+RareEventEstimate importance_sampling(const SweepConfig& config, int k, const SweepPoint& point);
+
+// "shots" shots at splitting_start, then splitting_steps Metropolis steps per rung down to the point
+RareEventEstimate splitting(const SweepConfig& config, int k, const SweepPoint& point);
+
+// every point of the grid with the estimator of the config
+std::vector<RareEventEstimate> run_rare_event(const SweepConfig& config);
+
+// one CSV row per point, with a normal (importance) or log-normal (splitting) interval
+void write_rare_event_results(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<RareEventEstimate>& estimates,
+    double confidence
+);
+
+}
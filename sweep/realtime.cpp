@@ -0,0 +1,231 @@
+#include "realtime.hpp"
+#include "bounded_queue.hpp"
+#include "exception.hpp"
+#include "latency.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <utility>
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Block {
+    int index;
+    Clock::time_point ready;
+};
+
+struct Shot {
+    Err::PlanarData data;
+    std::shared_ptr<Err::CodeScheme::PlanarErasure> erasure;
+};
+
+// the blocks are simulated ahead and replayed: simulating a round takes longer than a cycle of real hardware
+std::vector<Shot> make_pool(const SweepConfig& config, const SweepPoint& point) {
+    const long long max_pool = 1024;
+    auto error_model = make_error_model(point);
+    error_model->seed(latency_seed(config.seed, point));
+    auto code = Err::PlanarSurfaceCode(point.d, error_model);
+    auto ret = std::vector<Shot>();
+    for(long long _ = 0; _ < std::min(config.shots, max_pool); _++) {
+        code.step(point.rounds);
+        ret.push_back({code.get_data(), code.get_erasure()});
+        code.reset();
+    }
+    return ret;
+}
+
+// the pool replays its shots, a cache would hit on every repeat; circuit noise has no error model to step
+void check_supported(const std::string& noise, const std::string& decoder) {
+    if(noise == "circuit")
+        throw BadConfig(std::string("Realtime runs step an error model per round, circuit noise has none"));
+    if(decoder == "mwpm_cached")
+        throw BadConfig(std::string("Realtime runs replay a pool of shots, the hits of mwpm_cached would be inflated"));
+}
+
+struct ConsumerStats {
+    long long decoded = 0, late = 0;
+    double sum_latency = 0, max_latency = 0, busy = 0;
+};
+
+}
+
+RealtimeReport simulate_realtime(const SweepConfig& config, const SweepPoint& point, double cycle) {
+    check_supported(point.noise, point.decoder);
+    auto ret = RealtimeReport();
+    ret.cycle = cycle, ret.threads = config.realtime_threads;
+    auto pool = make_pool(config, point);
+    auto shape = Err::CodeScheme::PlanarShape(point.d, point.d);
+    // the decoders keep state between calls, every thread owns one, built here so a bad point fails before any thread
+    auto decoders = std::vector<std::shared_ptr<Dc::DecoderBase>>();
+    for(int n = 0; n < config.realtime_threads; n++)
+        decoders.push_back(make_decoder(point, shape, nullptr));
+    auto queue = BoundedQueue<Block>(std::max(1ll, config.realtime_queue / point.rounds));
+
+    auto stats = std::vector<ConsumerStats>(config.realtime_threads);
+    auto consumers = std::vector<std::thread>();
+    auto begin = Clock::now();
+    for(int n = 0; n < config.realtime_threads; n++) {
+        consumers.push_back(std::thread([&, n]() {
+            auto& decoder = decoders[n];
+            auto& local = stats[n];
+            Block block;
+            bool closed = false;
+            while(true) {
+                // poll as a real-time decoder would, waking a sleeping thread takes longer than a cycle
+                if(!queue.try_pop(block, closed)) {
+                    if(closed)
+                        break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                auto start = Clock::now();
+                auto& shot = pool[block.index];
+                auto correction = decode_shot(*decoder, shot.data, shot.erasure);
+                auto stop = Clock::now();
+                double latency = std::chrono::duration<double, std::micro>(stop - block.ready).count();
+                local.decoded++;
+                local.sum_latency += latency;
+                local.max_latency = std::max(local.max_latency, latency);
+                local.busy += std::chrono::duration<double>(stop - start).count();
+                if(config.realtime_deadline > 0 && latency > config.realtime_deadline)
+                    local.late++;
+            }
+        }));
+    }
+
+    // the producer: block b is ready once its rounds have been emitted, one per cycle
+    auto period = std::chrono::duration<double, std::micro>(cycle * point.rounds);
+    auto start = Clock::now();
+    double sum_backlog = 0;
+    for(long long b = 0; b < config.shots; b++) {
+        auto ready = start + std::chrono::duration_cast<Clock::duration>(period * (double)(b + 1));
+        auto now = Clock::now();
+        while(now < ready)
+            now = Clock::now();
+        // late by more than a cycle: the producer is the bottleneck
+        if(now - ready > std::chrono::duration<double, std::micro>(cycle))
+            ret.producer_late += point.rounds;
+        size_t size = 0;
+        if(queue.try_push({(int)(b % (long long)pool.size()), ready}, size)) {
+            double backlog = (double)size * point.rounds;
+            sum_backlog += backlog;
+            ret.max_backlog = std::max(ret.max_backlog, backlog);
+        } else {
+            ret.dropped++;
+            sum_backlog += (double)queue.size() * point.rounds;
+        }
+        ret.blocks++;
+    }
+    ret.final_backlog = (double)queue.size() * point.rounds;
+    queue.close();
+    for(auto& consumer: consumers)
+        consumer.join();
+    double duration = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double busy = 0, sum_latency = 0;
+    for(auto& local: stats) {
+        ret.decoded += local.decoded;
+        ret.late += local.late;
+        sum_latency += local.sum_latency;
+        ret.max_latency = std::max(ret.max_latency, local.max_latency);
+        busy += local.busy;
+    }
+    ret.mean_backlog = sum_backlog / std::max(1ll, ret.blocks);
+    ret.mean_latency = sum_latency / std::max(1ll, ret.decoded);
+    ret.utilisation = busy / (duration * config.realtime_threads);
+    // a backlog still growing at the end would overflow a longer run, at most a block per thread may wait
+    bool bounded = ret.final_backlog <= (double)config.realtime_threads * point.rounds;
+    // a run the producer could not keep to its cycle says nothing about the decoders at that cycle
+    ret.keeps_up = (ret.dropped == 0 && ret.late == 0 && bounded && ret.producer_late * 100 <= ret.blocks * point.rounds);
+    ret.seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    return ret;
+}
+
+RealtimeReport search_cycle(const SweepConfig& config, const SweepPoint& point) {
+    // bracket the shortest cycle by factors of 2, then bisect it geometrically
+    const double shortest = 1e-3, longest = 1e6;
+    double cycle = config.realtime_cycle;
+    auto report = simulate_realtime(config, point, cycle);
+    double good = -1, bad = -1;
+    auto best = RealtimeReport();
+    if(report.keeps_up) {
+        good = cycle, best = report;
+        while(good / 2 >= shortest) {
+            report = simulate_realtime(config, point, good / 2);
+            if(!report.keeps_up) {
+                bad = good / 2;
+                break;
+            }
+            good /= 2, best = report;
+        }
+        if(bad < 0)
+            return best;
+    } else {
+        bad = cycle;
+        while(bad * 2 <= longest) {
+            report = simulate_realtime(config, point, bad * 2);
+            if(report.keeps_up) {
+                good = bad * 2, best = report;
+                break;
+            }
+            bad *= 2;
+        }
+        if(good < 0)
+            return report;
+    }
+    while(good / bad > 1.05) {
+        double middle = std::sqrt(good * bad);
+        report = simulate_realtime(config, point, middle);
+        if(report.keeps_up)
+            good = middle, best = report;
+        else
+            bad = middle;
+    }
+    return best;
+}
+
+std::vector<RealtimeReport> run_realtime(const SweepConfig& config) {
+    for(auto& noise: config.noise_list) {
+        for(auto& decoder: config.decoder_list)
+            check_supported(noise, decoder);
+    }
+    auto ret = std::vector<RealtimeReport>();
+    for(auto& point: config.points()) {
+        if(config.realtime_search)
+            ret.push_back(search_cycle(config, point));
+        else
+            ret.push_back(simulate_realtime(config, point, config.realtime_cycle));
+    }
+    return ret;
+}
+
+void write_realtime(std::string path, const std::vector<SweepPoint>& points, const std::vector<RealtimeReport>& reports) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    file << "d,p,p_eff,noise,decoder,rounds,threads,cycle_us,blocks,decoded,dropped,late,producer_late,"
+         << "mean_backlog,max_backlog,final_backlog,mean_latency_us,max_latency_us,utilisation,keeps_up,max_round_rate,seconds" << std::endl;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        auto& report = reports[k];
+        file << point.d << "," << point.p << "," << point.p_eff << "," << point.noise << "," << point.decoder << "," << point.rounds << ","
+             << report.threads << "," << report.cycle << "," << report.blocks << "," << report.decoded << "," << report.dropped << ","
+             << report.late << "," << report.producer_late << "," << report.mean_backlog << "," << report.max_backlog << ","
+             << report.final_backlog << "," << report.mean_latency << "," << report.max_latency << "," << report.utilisation << ","
+             << (report.keeps_up ? 1 : 0) << "," << (report.keeps_up ? 1e6 / report.cycle : 0) << "," << report.seconds << std::endl;
+    }
+}
+
+}
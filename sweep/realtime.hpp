@@ -0,0 +1,54 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct RealtimeReport {
+    /*
+    One real-time run of a point. A producer emits a syndrome round every
+    cycle microseconds; the rounds one decode sees form a block, which is put
+    into a bounded queue when its last round is out and dropped if the queue is
+    full. Decoder threads take the blocks from the queue. The backlog is the
+    number of rounds waiting in the queue, sampled at every push.
+
+    The decoders keep up when no block was dropped, with a deadline none was
+    decoded late, and the backlog left when the producer stops is at most a
+    block per thread: a decoder slightly slower than the cycle grows it without
+    bound, whether or not the queue overflowed within the run. The producer
+    must also have emitted at least 99% of the rounds within a cycle of their
+    time, otherwise the run was slower than asked; producer_late counts the
+    rounds it missed. The producer and every decoder thread spin, so they each
+    need a core of their own.
+    */
+    double cycle;
+    int threads;
+    long long blocks, decoded, dropped, late, producer_late;
+    double mean_backlog, max_backlog, final_backlog;
+    // microseconds from the time a block is ready to the end of its decode
+    double mean_latency, max_latency;
+    // the busy time of the decoder threads over their time
+    double utilisation;
+    double seconds;
+    bool keeps_up;
+
+    inline RealtimeReport() : cycle(0), threads(0), blocks(0), decoded(0), dropped(0), late(0), producer_late(0),
+        mean_backlog(0), max_backlog(0), final_backlog(0), mean_latency(0), max_latency(0), utilisation(0), seconds(0), keeps_up(false) {}
+};
+
+// "shots" blocks of the point at the given cycle time, in microseconds per round
+RealtimeReport simulate_realtime(const SweepConfig& config, const SweepPoint& point, double cycle);
+
+// the shortest cycle time the decoders keep up with, within 5%, starting from realtime_cycle
+RealtimeReport search_cycle(const SweepConfig& config, const SweepPoint& point);
+
+// every point of the grid, searched if realtime_search is set
+std::vector<RealtimeReport> run_realtime(const SweepConfig& config);
+
+// one CSV row per point, max_round_rate is the rounds per second the decoders kept up with
+void write_realtime(std::string path, const std::vector<SweepPoint>& points, const std::vector<RealtimeReport>& reports);
+
+}
@@ -0,0 +1,32 @@
+#include "statistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Sweep {
+
+double normal_quantile(double q) {
+    // bisection on the normal CDF, accurate to well below the precision we report
+    double low = -40, high = 40;
+    for(int _ = 0; _ < 200; _++) {
+        double mid = (low + high) / 2;
+        if(0.5 * std::erfc(-mid / std::sqrt(2.0)) < q)
+            low = mid;
+        else
+            high = mid;
+    }
+    return (low + high) / 2;
+}
+
+std::pair<double, double> wilson_interval(long long failures, long long shots, double confidence) {
+    if(shots == 0)
+        return std::make_pair(0.0, 1.0);
+    double z = normal_quantile(0.5 + confidence / 2);
+    double n = (double)shots;
+    double p = (double)failures / n;
+    double denominator = 1 + z * z / n;
+    double center = (p + z * z / (2 * n)) / denominator;
+    double half_width = z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / denominator;
+    return std::make_pair(std::max(0.0, center - half_width), std::min(1.0, center + half_width));
+}
+
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <utility>
+
+namespace Sweep {
+
+// the z such that P(N(0, 1) < z) = q
+double normal_quantile(double q);
+
+// Wilson score interval of a binomial proportion at the given confidence level
+std::pair<double, double> wilson_interval(long long failures, long long shots, double confidence);
+
+}
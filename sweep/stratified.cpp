@@ -0,0 +1,186 @@
+#include "stratified.hpp"
+#include "exception.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <omp.h>
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+double binomial_probability(int n, int k, double p) {
+    if(p <= 0)
+        return k == 0 ? 1.0 : 0.0;
+    if(p >= 1)
+        return k == n ? 1.0 : 0.0;
+    return std::exp(std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0) + k * std::log(p) + (n - k) * std::log1p(-p));
+}
+
+int stratified_max_weight(int num_data, double p_eff, double tail) {
+    double mass = 0;
+    for(int k = 0; k < num_data; k++) {
+        mass += binomial_probability(num_data, k, p_eff);
+        if(1 - mass <= tail)
+            return k;
+    }
+    return num_data;
+}
+
+static void check_point(const SweepPoint& point) {
+    // with iid_independent the ratio of X, Y and Z changes with p, and f(k) with it
+    if(point.noise != "iid_balanced")
+        throw BadConfig(std::string("Stratified sampling needs iid_balanced noise, not ") + point.noise);
+    if(point.decoder != "mwpm" && point.decoder != "mwpm_cached")
+        throw BadConfig(std::string("Stratified sampling needs a matching decoder, not ") + point.decoder);
+    if(point.rounds > 1)
+        throw BadConfig(std::string("Stratified sampling only supports perfect measurements"));
+}
+
+Tally run_fixed_weight_batch(const SweepPoint& point, int k, int batch_size, unsigned long long seed) {
+    check_point(point);
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = Tally();
+    auto error_model = std::make_shared<Err::ErrorModel::FixedWeightError>(k);
+    error_model->seed(seed);
+    auto code = Err::PlanarSurfaceCode(point.d, error_model);
+    // the matching weights of balanced noise do not depend on p
+    auto decoder = Dc::Matching::StandardMWPMDecoder(point.p_eff, point.p_eff, point.p_eff, 0, false, code.get_shape());
+
+    for(int _ = 0; _ < batch_size; _++) {
+        code.step();
+        auto data = code.get_data();
+        auto correction = decoder(data);
+        auto stat = data.second->count_errors();
+
+        auto corrected = data.second * correction;
+        ret.shots++;
+        if(!corrected->is_correct()) {
+            ret.failures++;
+            ret.y_errors += stat[2];
+            ret.total_errors += (stat[1] + stat[2] + stat[3]);
+        }
+        code.reset();
+    }
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ret;
+}
+
+RareEventEstimate StrataTable::synthesise(double p_eff) const {
+    auto ret = RareEventEstimate();
+    ret.method = "stratified";
+    double variance = 0;
+    for(int k = 0; k < (int)strata.size(); k++) {
+        auto& stratum = strata[k];
+        double weight = binomial_probability(num_data, k, p_eff);
+        double f = stratum.rate();
+        ret.p_L += weight * f;
+        if(stratum.shots > 0)
+            variance += weight * weight * f * (1 - f) / (double)stratum.shots;
+        ret.shots += stratum.shots, ret.failures += stratum.failures;
+        ret.seconds += stratum.seconds;
+    }
+    for(int k = (int)strata.size(); k <= num_data; k++)
+        ret.tail += binomial_probability(num_data, k, p_eff);
+    ret.std_error = std::sqrt(variance);
+    return ret;
+}
+
+std::vector<StrataTable> sample_strata(const SweepConfig& config) {
+    auto points = config.points();
+    auto tables = std::vector<StrataTable>();
+    // the points of a table only differ in p
+    auto table_of = std::vector<int>(points.size());
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        check_point(point);
+        int g = 0;
+        while(g < (int)tables.size() && !(tables[g].point.d == point.d && tables[g].point.noise == point.noise && tables[g].point.decoder == point.decoder))
+            g++;
+        if(g == (int)tables.size()) {
+            auto table = StrataTable();
+            table.point = point;
+            auto code = Err::PlanarSurfaceCode(point.d, std::make_shared<Err::ErrorModel::FixedWeightError>(0));
+            table.num_data = (code.get_shape().x() * code.get_shape().y() + 1) / 2;
+            tables.push_back(table);
+        }
+        table_of[k] = g;
+    }
+
+    auto max_weight = std::vector<int>(tables.size(), 0);
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& table = tables[table_of[k]];
+        int weight = (config.max_weight > 0 ? config.max_weight : stratified_max_weight(table.num_data, points[k].p_eff, config.stratified_tail));
+        max_weight[table_of[k]] = std::max(max_weight[table_of[k]], std::min(weight, table.num_data));
+    }
+
+    // no fault, no failure: stratum 0 is never sampled
+    long long batches = (config.shots + config.batch_size - 1) / config.batch_size;
+    auto tasks = std::vector<std::pair<int, int>>();
+    for(int g = 0; g < (int)tables.size(); g++) {
+        tables[g].strata = std::vector<Tally>(max_weight[g] + 1);
+        for(int k = 1; k <= max_weight[g]; k++)
+            tasks.push_back(std::make_pair(g, k));
+    }
+
+    #pragma omp parallel num_threads(config.num_thread)
+    {
+        auto local = std::vector<std::vector<Tally>>();
+        for(auto& table: tables)
+            local.push_back(std::vector<Tally>(table.strata.size()));
+        #pragma omp for schedule(dynamic, 1) collapse(2) nowait
+        for(long long n = 0; n < (long long)tasks.size(); n++) {
+            for(long long b = 0; b < batches; b++) {
+                int g = tasks[n].first, k = tasks[n].second;
+                int shots = (int)std::min<long long>(config.batch_size, config.shots - b * config.batch_size);
+                local[g][k] += run_fixed_weight_batch(tables[g].point, k, shots, derive_seed(config.seed, g, ((unsigned long long)k << 32) | b));
+            }
+        }
+        #pragma omp critical
+        {
+            for(int g = 0; g < (int)tables.size(); g++) {
+                for(int k = 0; k < (int)tables[g].strata.size(); k++)
+                    tables[g].strata[k] += local[g][k];
+            }
+        }
+    }
+    return tables;
+}
+
+std::vector<RareEventEstimate> run_stratified(const SweepConfig& config) {
+    auto points = config.points();
+    auto tables = sample_strata(config);
+    if(!config.strata_output.empty())
+        write_strata(config.strata_output, tables);
+
+    auto ret = std::vector<RareEventEstimate>();
+    for(auto& point: points) {
+        for(auto& table: tables) {
+            if(table.point.d == point.d && table.point.noise == point.noise && table.point.decoder == point.decoder) {
+                ret.push_back(table.synthesise(point.p_eff));
+                break;
+            }
+        }
+    }
+    return ret;
+}
+
+void write_strata(std::string path, const std::vector<StrataTable>& tables) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    file << "d,noise,decoder,num_data,k,shots,failures,f,seconds" << std::endl;
+    for(auto& table: tables) {
+        for(int k = 0; k < (int)table.strata.size(); k++) {
+            auto& stratum = table.strata[k];
+            file << table.point.d << "," << table.point.noise << "," << table.point.decoder << "," << table.num_data << ","
+                 << k << "," << stratum.shots << "," << stratum.failures << "," << stratum.rate() << "," << stratum.seconds << std::endl;
+        }
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "rare_event.hpp"
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct StrataTable {
+    /*
+    The failure rate f(k) of a (d, noise, decoder) given exactly k faults on its
+    num_data data qubits, sampled for k = 0 .. strata.size() - 1. For iid noise
+    with a fixed ratio of X, Y and Z,
+
+        p_L(p) = sum_k Binom(num_data, k; p) f(k)
+
+    so one table serves every p of the grid.
+    */
+    SweepPoint point;
+    int num_data;
+    std::vector<Tally> strata;
+
+    // p_L at p_eff from the sampled strata, the binomial weight of the others goes to the tail
+    RareEventEstimate synthesise(double p_eff) const;
+};
+
+// Binom(n, k; p)
+double binomial_probability(int n, int k, double p);
+
+// the smallest max_weight whose binomial tail at p_eff is at most tail
+int stratified_max_weight(int num_data, double p_eff, double tail);
+
+// batch_size shots of point with exactly k faults
+Tally run_fixed_weight_batch(const SweepPoint& point, int k, int batch_size, unsigned long long seed);
+
+// "shots" shots per stratum for every (d, noise, decoder) of the grid
+std::vector<StrataTable> sample_strata(const SweepConfig& config);
+
+// p_L at every point of the grid from the tables of sample_strata
+std::vector<RareEventEstimate> run_stratified(const SweepConfig& config);
+
+// one CSV row per stratum
+void write_strata(std::string path, const std::vector<StrataTable>& tables);
+
+}
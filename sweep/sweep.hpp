@@ -0,0 +1,14 @@
+#pragma once
+
+#include "exception.hpp"
+#include "statistics.hpp"
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include "sweep_log.hpp"
+#include "sweep_engine.hpp"
+#include "rare_event.hpp"
+#include "stratified.hpp"
+#include "threshold.hpp"
+#include "latency.hpp"
+#include "realtime.hpp"
+#include "pipeline.hpp"
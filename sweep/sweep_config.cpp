@@ -0,0 +1,289 @@
+#include "sweep_config.hpp"
+#include "exception.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <omp.h>
+
+namespace Sweep {
+
+SweepConfig::SweepConfig() {
+    noise_list = std::vector<std::string>({"iid_balanced"});
+    decoder_list = std::vector<std::string>({"mwpm"});
+    rounds_list = std::vector<int>({1});
+    shots = 10000;
+    batch_size = 1000;
+    num_thread = omp_get_max_threads();
+    std::random_device random_device{};
+    seed = ((unsigned long long)random_device() << 32) | random_device();
+    p_exponent = 1;
+    output = "sweep_out.csv";
+    target_rel_error = 0, target_ci_width = 0, confidence = 0.95;
+    min_shots = 0, max_failures = 0;
+    time_budget = 0;
+    checkpoint = "";
+    checkpoint_interval = 60;
+    estimator = "direct";
+    is_scale = 0, splitting_start = 0;
+    splitting_steps = 100000;
+    max_weight = 0, stratified_tail = 1e-6;
+    strata_output = "";
+    threshold_ci_width = 0, threshold_window = 0.3;
+    threshold_iterations = 5, threshold_points = 5, bootstrap = 200;
+    threshold_output = "";
+    stats_output = "";
+    latency_warmup = 1000, latency_cpu = -1, latency_budget = 1;
+    latency_output = "";
+    realtime_cycle = 1, realtime_deadline = 0;
+    realtime_queue = 1000, realtime_threads = 1;
+    realtime_search = false;
+    realtime_output = "";
+    pipeline_generators = 1, pipeline_decoders = 0, pipeline_buffers = 256;
+    shard_index = 0, shard_count = 1;
+    has_seed = false;
+}
+
+SweepConfig SweepConfig::load(std::string path) {
+    std::ifstream file(path);
+    if(!file.is_open())
+        throw BadConfig(std::string("Cannot open the config file: ") + path);
+
+    auto config = SweepConfig();
+    std::string line;
+    int line_number = 0;
+    while(std::getline(file, line)) {
+        line_number++;
+        auto comment = line.find('#');
+        if(comment != std::string::npos)
+            line = line.substr(0, comment);
+        std::istringstream stream(line);
+        std::string key;
+        if(!(stream >> key))
+            continue;
+
+        auto bad_value = [&]() {
+            return BadConfig(path + ":" + std::to_string(line_number) + ": bad value for \"" + key + "\"");
+        };
+        auto read_list = [&](auto& list) {
+            list.clear();
+            typename std::remove_reference<decltype(list)>::type::value_type value;
+            while(stream >> value)
+                list.push_back(value);
+            if(!stream.eof() || list.empty())
+                throw bad_value();
+        };
+        auto read_one = [&](auto& value) {
+            if(!(stream >> value))
+                throw bad_value();
+        };
+
+        if(key == "d")
+            read_list(config.d_list);
+        else if(key == "p")
+            read_list(config.p_list);
+        else if(key == "noise")
+            read_list(config.noise_list);
+        else if(key == "decoder")
+            read_list(config.decoder_list);
+        else if(key == "rounds")
+            read_list(config.rounds_list);
+        else if(key == "shots")
+            read_one(config.shots);
+        else if(key == "batch_size")
+            read_one(config.batch_size);
+        else if(key == "threads")
+            read_one(config.num_thread);
+        else if(key == "seed") {
+            read_one(config.seed);
+            config.has_seed = true;
+        }
+        else if(key == "p_exponent")
+            read_one(config.p_exponent);
+        else if(key == "output")
+            read_one(config.output);
+        else if(key == "target_rel_error")
+            read_one(config.target_rel_error);
+        else if(key == "target_ci_width")
+            read_one(config.target_ci_width);
+        else if(key == "confidence")
+            read_one(config.confidence);
+        else if(key == "min_shots")
+            read_one(config.min_shots);
+        else if(key == "max_failures")
+            read_one(config.max_failures);
+        else if(key == "time_budget")
+            read_one(config.time_budget);
+        else if(key == "checkpoint")
+            read_one(config.checkpoint);
+        else if(key == "checkpoint_interval")
+            read_one(config.checkpoint_interval);
+        else if(key == "estimator")
+            read_one(config.estimator);
+        else if(key == "is_scale")
+            read_one(config.is_scale);
+        else if(key == "splitting_start")
+            read_one(config.splitting_start);
+        else if(key == "splitting_steps")
+            read_one(config.splitting_steps);
+        else if(key == "max_weight")
+            read_one(config.max_weight);
+        else if(key == "stratified_tail")
+            read_one(config.stratified_tail);
+        else if(key == "strata_output")
+            read_one(config.strata_output);
+        else if(key == "threshold_ci_width")
+            read_one(config.threshold_ci_width);
+        else if(key == "threshold_iterations")
+            read_one(config.threshold_iterations);
+        else if(key == "threshold_points")
+            read_one(config.threshold_points);
+        else if(key == "threshold_window")
+            read_one(config.threshold_window);
+        else if(key == "bootstrap")
+            read_one(config.bootstrap);
+        else if(key == "threshold_output")
+            read_one(config.threshold_output);
+        else if(key == "stats_output")
+            read_one(config.stats_output);
+        else if(key == "latency_warmup")
+            read_one(config.latency_warmup);
+        else if(key == "latency_cpu")
+            read_one(config.latency_cpu);
+        else if(key == "latency_budget")
+            read_one(config.latency_budget);
+        else if(key == "latency_output")
+            read_one(config.latency_output);
+        else if(key == "realtime_cycle")
+            read_one(config.realtime_cycle);
+        else if(key == "realtime_queue")
+            read_one(config.realtime_queue);
+        else if(key == "realtime_deadline")
+            read_one(config.realtime_deadline);
+        else if(key == "realtime_threads")
+            read_one(config.realtime_threads);
+        else if(key == "realtime_search")
+            read_one(config.realtime_search);
+        else if(key == "realtime_output")
+            read_one(config.realtime_output);
+        else if(key == "pipeline_generators")
+            read_one(config.pipeline_generators);
+        else if(key == "pipeline_decoders")
+            read_one(config.pipeline_decoders);
+        else if(key == "pipeline_buffers")
+            read_one(config.pipeline_buffers);
+        else if(key == "shard") {
+            std::string shard;
+            read_one(shard);
+            config.set_shard(shard);
+        }
+        else
+            throw BadConfig(path + ":" + std::to_string(line_number) + ": unknown key \"" + key + "\"");
+    }
+
+    if(config.d_list.empty() || config.p_list.empty())
+        throw BadConfig(path + ": \"d\" and \"p\" are required");
+    for(auto d: config.d_list) {
+        if(d < 3 || d % 2 == 0)
+            throw BadConfig(path + ": the distances should be odd and at least 3");
+    }
+    for(auto rounds: config.rounds_list) {
+        if(rounds <= 0)
+            throw BadConfig(path + ": \"rounds\" should be positive");
+    }
+    if(config.shots <= 0 || config.batch_size <= 0 || config.num_thread <= 0)
+        throw BadConfig(path + ": \"shots\", \"batch_size\" and \"threads\" should be positive");
+    if(config.confidence <= 0 || config.confidence >= 1)
+        throw BadConfig(path + ": \"confidence\" should be in (0, 1)");
+    if(config.estimator != "direct" && config.estimator != "importance" && config.estimator != "splitting" && config.estimator != "stratified")
+        throw BadConfig(path + ": \"estimator\" should be direct, importance, splitting or stratified");
+    if(config.splitting_steps < 20)
+        throw BadConfig(path + ": \"splitting_steps\" should be at least 20");
+    if(config.threshold_points <= 0 || config.threshold_window <= 0 || config.bootstrap < 0)
+        throw BadConfig(path + ": \"threshold_points\" and \"threshold_window\" should be positive");
+    if(config.pipeline_generators <= 0 || config.pipeline_decoders < 0 || config.pipeline_buffers <= 0)
+        throw BadConfig(path + ": \"pipeline_generators\" and \"pipeline_buffers\" should be positive");
+    if(config.pipeline_decoders > 0 && std::count(config.noise_list.begin(), config.noise_list.end(), std::string("circuit")))
+        throw BadConfig(path + ": circuit noise has no error model of a round for the pipeline, set \"pipeline_decoders\" to 0");
+    if(config.latency_warmup < 0 || config.latency_budget <= 0)
+        throw BadConfig(path + ": \"latency_warmup\" should not be negative and \"latency_budget\" should be positive");
+    if(config.realtime_cycle <= 0 || config.realtime_queue <= 0 || config.realtime_threads <= 0 || config.realtime_deadline < 0)
+        throw BadConfig(path + ": \"realtime_cycle\", \"realtime_queue\" and \"realtime_threads\" should be positive");
+
+    auto resolve = [&path](std::string& file_path) {
+        if(!file_path.empty() && std::filesystem::path(file_path).is_relative())
+            file_path = (std::filesystem::path(path).parent_path() / file_path).string();
+    };
+    resolve(config.output);
+    resolve(config.checkpoint);
+    resolve(config.strata_output);
+    resolve(config.threshold_output);
+    resolve(config.stats_output);
+    resolve(config.latency_output);
+    resolve(config.realtime_output);
+    return config;
+}
+
+void SweepConfig::set_shard(std::string shard) {
+    auto slash = shard.find('/');
+    try {
+        if(slash == std::string::npos)
+            throw std::invalid_argument(shard);
+        shard_index = std::stoi(shard.substr(0, slash));
+        shard_count = std::stoi(shard.substr(slash + 1));
+    }
+    catch(const std::logic_error&) {
+        throw BadConfig(std::string("A shard is written as i/N: ") + shard);
+    }
+    if(shard_count <= 0 || shard_index < 0 || shard_index >= shard_count)
+        throw BadConfig(std::string("A shard should satisfy 0 <= i < N: ") + shard);
+}
+
+std::string SweepConfig::shard_log() const {
+    auto base = (checkpoint.empty() ? output : checkpoint);
+    return base + ".shard-" + std::to_string(shard_index) + "-of-" + std::to_string(shard_count) + ".log";
+}
+
+// out/sweep.csv -> out/sweep<suffix>.csv
+static std::string next_to_output(std::string output, std::string suffix) {
+    auto path = std::filesystem::path(output);
+    return (path.parent_path() / (path.stem().string() + suffix + path.extension().string())).string();
+}
+
+std::string SweepConfig::stats_path() const {
+    return stats_output.empty() ? next_to_output(output, "_stats") : stats_output;
+}
+
+std::string SweepConfig::latency_path() const {
+    return latency_output.empty() ? next_to_output(output, "_latency") : latency_output;
+}
+
+std::string SweepConfig::realtime_path() const {
+    return realtime_output.empty() ? next_to_output(output, "_realtime") : realtime_output;
+}
+
+std::vector<SweepPoint> SweepConfig::points() const {
+    auto ret = std::vector<SweepPoint>();
+    for(auto d: d_list) {
+        for(auto p: p_list) {
+            for(auto& noise: noise_list) {
+                for(auto& decoder: decoder_list) {
+                    for(auto rounds: rounds_list) {
+                        auto point = SweepPoint();
+                        point.d = d, point.p = p;
+                        point.p_eff = 1.0 - pow(1.0 - p, p_exponent);
+                        point.noise = noise, point.decoder = decoder;
+                        point.rounds = rounds;
+                        ret.push_back(point);
+                    }
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct SweepConfig {
+    /*
+    A sweep over the grid d x p x noise x decoder x rounds. The config file has
+    one "key value..." entry per line, "#" starts a comment:
+
+        d 7 11 15 19 23 27
+        p 0.001 0.002 0.005 0.01
+        noise iid_independent
+        decoder mwpm
+        rounds 1
+        shots 1000000
+        batch_size 1000
+        threads 50
+        seed 2023
+        p_exponent 8
+        output out/MWPM_2d_out_independent.csv
+
+    The physical error rate of a point is p_eff = 1 - (1 - p) ^ p_exponent.
+    Relative file paths are taken relative to the directory of the config file.
+
+    Without a stopping target every point gets exactly "shots" shots. With
+
+        target_rel_error 0.1    # half-width of the interval over p_L
+        target_ci_width 0.001   # full width of the interval
+        confidence 0.95
+        min_shots 10000
+        max_failures 1000
+        time_budget 3600        # seconds for the whole grid
+
+    a point is sampled until one of its targets is met, "shots" (now a per-point
+    cap) or "max_failures" is reached, or the time budget of the grid runs out.
+
+        checkpoint out/sweep.log
+        checkpoint_interval 60  # seconds
+
+    appends every finished batch to a SweepLog, flushed at the given interval.
+    If the log already exists, the sweep resumes from it with the seed it records.
+
+        pipeline_generators 2   # simulating threads
+        pipeline_decoders 30    # decoding threads, 0 (default) runs a batch per thread instead
+        pipeline_buffers 256    # shots in flight
+
+    runs the batches through a ShotPipeline, see pipeline.hpp, with the same tallies.
+    "threads" is then not used.
+
+        shard 2/8
+
+    runs only the batches b of point k with (k + b) mod 8 = 2 and logs them to
+    shard_log(). The shards of a grid with a fixed seed and a fixed number of shots
+    merge into the tallies of a single run.
+
+        estimator importance    # direct (default), importance, splitting or stratified
+        is_scale 0              # importance: bias of the error rates, 0 picks one per point
+        splitting_start 0.05    # splitting: p at the top of the ladder
+        splitting_steps 100000  # splitting: Metropolis steps per rung
+        max_weight 0            # stratified: the largest number of faults, 0 picks it from
+        stratified_tail 1e-6    #   the binomial tail at the largest p
+        strata_output out/strata.csv
+
+    estimates p_L with the estimators of rare_event.hpp, for iid noise and the matching
+    decoders. "shots" is then the number of biased shots, of direct shots at splitting_start,
+    or of shots per number of faults; the stopping targets and the checkpoint do not apply.
+    The stratified estimator samples once per (d, noise, decoder) for the whole p list and
+    needs iid_balanced noise.
+
+        threshold_ci_width 0.0005   # stop once the interval of p_th is this narrow
+        threshold_iterations 5      # at most this many focused rounds
+        threshold_points 5          # values of p per focused round
+        threshold_window 0.3        # fit within p_th * (1 +- window) once it has enough points
+        bootstrap 200               # resamples for the interval of p_th
+        threshold_output out/threshold.csv
+
+    configure find_threshold, which starts from the d x p grid, see threshold.hpp.
+
+        stats_output out/stats.csv
+
+    receives the counters, timers and histograms of instrument.hpp per point when
+    built with ENABLE_INSTRUMENTATION, by default next to the output with a "_stats"
+    suffix. Batches restored from a checkpoint are not counted.
+
+        latency_warmup 1000     # untimed decodes before the timed ones
+        latency_cpu 3           # pin the thread to a core, -1 (default) leaves it free
+        latency_budget 1        # microseconds per round
+        latency_output out/latency.csv
+
+    configure measure_latency, which times "shots" single decodes per point, see
+    latency.hpp. By default it writes next to the output with a "_latency" suffix.
+
+        realtime_cycle 1        # microseconds per syndrome round
+        realtime_queue 1000     # rounds the queue holds
+        realtime_deadline 0     # microseconds from a block to its correction, 0 for none
+        realtime_threads 1      # decoder threads
+        realtime_search 1       # look for the shortest cycle the decoders keep up with
+        realtime_output out/realtime.csv
+
+    configure simulate_realtime, which streams "shots" blocks of "rounds" rounds per
+    point, see realtime.hpp. By default it writes next to the output with a "_realtime" suffix.
+    */
+    std::vector<int> d_list;
+    std::vector<double> p_list;
+    std::vector<std::string> noise_list, decoder_list;
+    std::vector<int> rounds_list;
+    long long shots;
+    int batch_size;
+    int num_thread;
+    unsigned long long seed;
+    double p_exponent;
+    std::string output;
+
+    double target_rel_error, target_ci_width, confidence;
+    long long min_shots, max_failures;
+    double time_budget;
+
+    std::string checkpoint;
+    double checkpoint_interval;
+
+    std::string estimator;
+    double is_scale, splitting_start;
+    long long splitting_steps;
+    int max_weight;
+    double stratified_tail;
+    std::string strata_output;
+
+    double threshold_ci_width, threshold_window;
+    int threshold_iterations, threshold_points, bootstrap;
+    std::string threshold_output;
+
+    std::string stats_output;
+
+    long long latency_warmup;
+    int latency_cpu;
+    double latency_budget;
+    std::string latency_output;
+
+    double realtime_cycle, realtime_deadline;
+    long long realtime_queue;
+    int realtime_threads;
+    bool realtime_search;
+    std::string realtime_output;
+
+    int pipeline_generators, pipeline_decoders, pipeline_buffers;
+
+    int shard_index, shard_count;
+    bool has_seed;
+
+    SweepConfig();
+    static SweepConfig load(std::string path);
+
+    // "i/N"
+    void set_shard(std::string shard);
+    // the checkpoint log of this shard, next to the checkpoint, or the output if there is none
+    std::string shard_log() const;
+    // stats_output, or the output with a "_stats" suffix
+    std::string stats_path() const;
+    // latency_output, or the output with a "_latency" suffix
+    std::string latency_path() const;
+    // realtime_output, or the output with a "_realtime" suffix
+    std::string realtime_path() const;
+    inline bool owns(int k, long long batch) const { return (k + batch) % shard_count == shard_index; }
+
+    inline bool adaptive() const {
+        return target_rel_error > 0 || target_ci_width > 0 || max_failures > 0 || time_budget > 0;
+    }
+
+    // the grid, d outermost and rounds innermost
+    std::vector<SweepPoint> points() const;
+};
+
+}
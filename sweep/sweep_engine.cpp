@@ -0,0 +1,274 @@
+#include "sweep_engine.hpp"
+#include "exception.hpp"
+#include "pipeline.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <omp.h>
+
+namespace Sweep {
+
+SweepEngine::SweepEngine(const SweepConfig& _config) : config(_config) {
+    if(config.shard_count > 1) {
+        // a shard cannot see the tallies of the others, so every shard must run a fixed set of batches
+        if(config.adaptive())
+            throw BadConfig(std::string("A sharded sweep needs a fixed number of shots"));
+        if(!config.has_seed)
+            throw BadConfig(std::string("A sharded sweep needs a seed shared by the shards"));
+        config.checkpoint = config.shard_log();
+    }
+    points = config.points();
+    tallies = std::vector<Tally>(points.size());
+    stats = std::vector<ErrorDynamics::Util::Instrument::Stats>(points.size());
+    max_batches = (config.shots + config.batch_size - 1) / config.batch_size;
+    next_batch = std::vector<long long>(points.size(), 0);
+    issued = std::vector<long long>(points.size(), 0);
+    done = std::vector<std::set<long long>>(points.size());
+    status = std::vector<std::string>(points.size(), config.adaptive() ? "running" : "fixed");
+    for(auto& point: points) {
+        // the workers cannot pass an exception on, so a bad noise or decoder fails here
+        validate_point(point);
+        if(point.decoder == "mwpm_cached")
+            caches.push_back(std::make_shared<Decoder::Cache::DecodeCache>(1 << 16));
+        else
+            caches.push_back(nullptr);
+    }
+}
+
+double SweepEngine::estimate_cost(const SweepPoint& point) {
+    // building the graph is quadratic and matching is super-quadratic in the number of defects
+    double volume = (double)point.d * point.d * point.rounds;
+    double defects = 2.0 * point.p_eff * volume;
+    return volume + defects * defects;
+}
+
+int SweepEngine::batch_shots(long long batch) const {
+    return (int)std::min<long long>(config.batch_size, config.shots - batch * config.batch_size);
+}
+
+long long SweepEngine::take_batch(int k) {
+    while(next_batch[k] < max_batches && (done[k].count(next_batch[k]) || !config.owns(k, next_batch[k])))
+        next_batch[k]++;
+    if(next_batch[k] >= max_batches)
+        return -1;
+    issued[k]++;
+    return next_batch[k]++;
+}
+
+void SweepEngine::resume() {
+    if(config.checkpoint.empty())
+        return;
+    if(SweepLog::exists(config.checkpoint)) {
+        auto contents = SweepLog::read(config.checkpoint);
+        if(contents.batch_size != config.batch_size || contents.points.size() != points.size())
+            throw BadConfig(config.checkpoint + ": the checkpoint belongs to another sweep");
+        for(int k = 0; k < (int)points.size(); k++) {
+            auto& a = points[k];
+            auto& b = contents.points[k];
+            if(a.d != b.d || a.p != b.p || a.p_eff != b.p_eff || a.noise != b.noise || a.decoder != b.decoder || a.rounds != b.rounds)
+                throw BadConfig(config.checkpoint + ": the checkpoint belongs to another sweep");
+        }
+        config.seed = contents.seed;
+        for(auto& record: contents.batches) {
+            if(!done[record.point].insert(record.batch).second)
+                continue;
+            tallies[record.point] += record.tally;
+            issued[record.point]++;
+        }
+    }
+    log = std::make_unique<SweepLog>(config.checkpoint, config, points);
+}
+
+void SweepEngine::run_tasks(std::vector<std::pair<int, long long>> tasks) {
+    auto cost = std::vector<double>(points.size());
+    for(int k = 0; k < (int)points.size(); k++)
+        cost[k] = estimate_cost(points[k]);
+    std::stable_sort(tasks.begin(), tasks.end(), [&cost](const std::pair<int, long long>& a, const std::pair<int, long long>& b) {
+        return cost[a.first] > cost[b.first];
+    });
+
+    auto last_flush = std::chrono::steady_clock::now();
+    if(config.pipeline_decoders > 0) {
+        // no per-point instrumentation here, the stages of a shot run on different threads
+        auto pipeline = ShotPipeline(config, points, caches);
+        pipeline.run(tasks, [&](int k, long long b, const Tally& tally) {
+            tallies[k] += tally;
+            if(!log)
+                return;
+            log->add_batch(k, b, tally);
+            auto now = std::chrono::steady_clock::now();
+            if(std::chrono::duration<double>(now - last_flush).count() >= config.checkpoint_interval) {
+                log->flush();
+                last_flush = now;
+            }
+        });
+        if(log)
+            log->flush();
+        return;
+    }
+    // the first exception of a worker, rethrown once the others have stopped
+    std::exception_ptr error;
+    std::atomic<bool> failed(false);
+    #pragma omp parallel num_threads(config.num_thread)
+    {
+        auto local = std::vector<Tally>(points.size());
+        auto local_stats = std::vector<ErrorDynamics::Util::Instrument::Stats>(ErrorDynamics::Util::Instrument::enabled ? points.size() : 0);
+        #pragma omp for schedule(dynamic, 1) nowait
+        for(long long n = 0; n < (long long)tasks.size(); n++) {
+            if(failed)
+                continue;
+            int k = tasks[n].first;
+            long long b = tasks[n].second;
+            auto before = ErrorDynamics::Util::Instrument::thread_stats();
+            Tally tally;
+            try {
+                tally = run_batch(points[k], batch_shots(b), derive_seed(config.seed, k, b), caches[k]);
+            }
+            catch(...) {
+                #pragma omp critical(sweep_error)
+                {
+                    if(!error)
+                        error = std::current_exception();
+                }
+                failed = true;
+                continue;
+            }
+            local[k] += tally;
+            if(ErrorDynamics::Util::Instrument::enabled)
+                local_stats[k] += ErrorDynamics::Util::Instrument::thread_stats() - before;
+            if(log) {
+                log->add_batch(k, b, tally);
+                #pragma omp critical(sweep_checkpoint)
+                {
+                    auto now = std::chrono::steady_clock::now();
+                    if(std::chrono::duration<double>(now - last_flush).count() >= config.checkpoint_interval) {
+                        log->flush();
+                        last_flush = now;
+                    }
+                }
+            }
+        }
+        #pragma omp critical
+        {
+            for(int k = 0; k < (int)points.size(); k++)
+                tallies[k] += local[k];
+            for(int k = 0; k < (int)local_stats.size(); k++)
+                stats[k] += local_stats[k];
+        }
+    }
+    if(log)
+        log->flush();
+    if(error)
+        std::rethrow_exception(error);
+}
+
+std::pair<double, double> SweepEngine::get_interval(int k) const {
+    return wilson_interval(tallies[k].failures, tallies[k].shots, config.confidence);
+}
+
+void SweepEngine::update_status(int k) {
+    if(status[k] != "running")
+        return;
+    auto& tally = tallies[k];
+    if(tally.shots >= config.shots) {
+        status[k] = "max_shots";
+        return;
+    }
+    if(config.max_failures > 0 && tally.failures >= config.max_failures) {
+        status[k] = "max_failures";
+        return;
+    }
+    if(tally.shots < config.min_shots)
+        return;
+    auto interval = get_interval(k);
+    double width = interval.second - interval.first;
+    if(config.target_ci_width > 0 && width <= config.target_ci_width)
+        status[k] = "converged";
+    else if(config.target_rel_error > 0 && tally.failures > 0 && width / 2 <= config.target_rel_error * tally.rate())
+        status[k] = "converged";
+}
+
+long long SweepEngine::remaining_shots(int k) const {
+    auto& tally = tallies[k];
+    double z = normal_quantile(0.5 + config.confidence / 2);
+    // a Laplace estimate keeps the first guesses finite
+    double p = ((double)tally.failures + 1) / ((double)tally.shots + 2);
+    double needed = (double)config.shots;
+    if(config.target_rel_error > 0)
+        needed = std::min(needed, z * z * (1 - p) / (p * config.target_rel_error * config.target_rel_error));
+    if(config.target_ci_width > 0)
+        needed = std::min(needed, 4 * z * z * p * (1 - p) / (config.target_ci_width * config.target_ci_width));
+    needed = std::max(needed, (double)config.min_shots);
+    long long remaining = (long long)std::ceil(needed) - tally.shots;
+    return std::min(std::max(remaining, (long long)config.batch_size), (max_batches - issued[k]) * config.batch_size);
+}
+
+std::vector<std::pair<int, long long>> SweepEngine::plan_epoch() {
+    auto running = std::vector<int>();
+    auto wanted = std::vector<long long>();
+    long long total = 0;
+    for(int k = 0; k < (int)points.size(); k++) {
+        if(status[k] != "running")
+            continue;
+        long long batches = (remaining_shots(k) + config.batch_size - 1) / config.batch_size;
+        // at most double the shots of a point per epoch, its estimate is refined on the way
+        batches = std::min(batches, std::max(1ll, issued[k]));
+        if(batches <= 0)
+            continue;
+        running.push_back(k);
+        wanted.push_back(batches);
+        total += batches;
+    }
+
+    long long capacity = std::max((long long)running.size(), 4ll * config.num_thread);
+    auto tasks = std::vector<std::pair<int, long long>>();
+    for(int n = 0; n < (int)running.size(); n++) {
+        int k = running[n];
+        long long batches = wanted[n];
+        if(total > capacity)
+            batches = std::max(1ll, batches * capacity / total);
+        for(long long _ = 0; _ < batches; _++) {
+            long long b = take_batch(k);
+            if(b < 0)
+                break;
+            tasks.push_back(std::make_pair(k, b));
+        }
+    }
+    return tasks;
+}
+
+void SweepEngine::run() {
+    resume();
+    if(!config.adaptive()) {
+        auto tasks = std::vector<std::pair<int, long long>>();
+        for(int k = 0; k < (int)points.size(); k++) {
+            for(long long b = take_batch(k); b >= 0; b = take_batch(k))
+                tasks.push_back(std::make_pair(k, b));
+        }
+        run_tasks(tasks);
+        return;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    while(true) {
+        for(int k = 0; k < (int)points.size(); k++)
+            update_status(k);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        if(config.time_budget > 0 && elapsed >= config.time_budget) {
+            for(int k = 0; k < (int)points.size(); k++) {
+                if(status[k] == "running")
+                    status[k] = "time_budget";
+            }
+            break;
+        }
+        auto tasks = plan_epoch();
+        if(tasks.empty())
+            break;
+        run_tasks(tasks);
+    }
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_log.hpp"
+#include "sweep_point.hpp"
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Sweep {
+
+class SweepEngine {
+    /*
+    Run every point of a SweepConfig. The shots are cut into batches and the
+    batches are put into one work list, the costliest first, which the threads
+    consume dynamically: a d = 27, p = 0.05 batch costs hundreds of d = 7,
+    p = 0.001 batches, so a static split per point leaves threads idle. Every
+    thread accumulates into its own tallies, merged at the end of the list.
+    With pipeline_decoders set, the list goes through a ShotPipeline instead.
+
+    In adaptive mode the grid is run in epochs. Before each epoch, the points
+    that met a stopping rule are retired and the batches of the epoch are
+    shared among the remaining points according to the number of shots they
+    are still estimated to need, so the budget flows to the slow points.
+
+    With a checkpoint log, the batches already in the log are skipped and the
+    tallies restored, so a resumed sweep runs exactly the batches it missed.
+    */
+    SweepConfig config;
+    std::vector<SweepPoint> points;
+    std::vector<Tally> tallies;
+    long long max_batches;
+    // the lowest batch index not handed out yet, and the number of batches handed out or restored
+    std::vector<long long> next_batch, issued;
+    std::vector<std::set<long long>> done;
+    std::unique_ptr<SweepLog> log;
+    // running, converged, max_shots, max_failures, time_budget or fixed
+    std::vector<std::string> status;
+    std::vector<std::shared_ptr<Decoder::Cache::DecodeCache>> caches;
+    // what the hot paths recorded per point, empty unless built with ENABLE_INSTRUMENTATION
+    std::vector<ErrorDynamics::Util::Instrument::Stats> stats;
+
+    // run (point, batch index) pairs in parallel and add them to the tallies
+    void run_tasks(std::vector<std::pair<int, long long>> tasks);
+    int batch_shots(long long batch) const;
+    // the next batch of a point which is not in the log, -1 if the point has no batch left
+    long long take_batch(int k);
+    void resume();
+
+    void update_status(int k);
+    long long remaining_shots(int k) const;
+    std::vector<std::pair<int, long long>> plan_epoch();
+
+    public:
+    SweepEngine() = delete;
+    SweepEngine(const SweepConfig& _config);
+
+    // a rough relative cost of one shot, used to order the work list
+    static double estimate_cost(const SweepPoint& point);
+
+    void run();
+
+    inline const std::vector<SweepPoint>& get_points() const { return points; }
+    inline const std::vector<Tally>& get_tallies() const { return tallies; }
+    inline const std::vector<std::string>& get_status() const { return status; }
+    inline const std::vector<ErrorDynamics::Util::Instrument::Stats>& get_stats() const { return stats; }
+    // the confidence interval of p_L at the configured confidence level
+    std::pair<double, double> get_interval(int k) const;
+
+    inline void write_results(std::string path) const { Sweep::write_results(path, points, tallies, status, config.confidence); }
+    inline void write_results() const { write_results(config.output); }
+    inline void write_stats(std::string path) const { Sweep::write_stats(path, points, stats); }
+    inline void write_stats() const { write_stats(config.stats_path()); }
+};
+
+}
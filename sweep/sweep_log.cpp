@@ -0,0 +1,209 @@
+#include "sweep_log.hpp"
+#include "exception.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <tuple>
+
+namespace Sweep {
+
+SweepLog::SweepLog(std::string path, const SweepConfig& config, const std::vector<SweepPoint>& points) {
+    bool fresh = !exists(path);
+    if(!fresh) {
+        // cut a torn last line before appending
+        std::ifstream in(path, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto last = content.find_last_of('\n');
+        size_t length = (last == std::string::npos ? 0 : last + 1);
+        if(length != content.size())
+            std::filesystem::resize_file(path, length);
+        fresh = (length == 0);
+    }
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    file.open(path, std::ios::app);
+    if(!file.is_open())
+        throw BadConfig(std::string("Cannot open the checkpoint log: ") + path);
+    if(fresh) {
+        file << std::setprecision(17);
+        file << "run " << config.seed << " " << config.batch_size << "\n";
+        for(int k = 0; k < (int)points.size(); k++) {
+            auto& point = points[k];
+            file << "point " << k << " " << point.d << " " << point.p << " " << point.p_eff << " "
+                 << point.noise << " " << point.decoder << " " << point.rounds << "\n";
+        }
+        file.flush();
+    }
+}
+
+void SweepLog::add_batch(int point, long long batch, const Tally& tally) {
+    std::ostringstream line;
+    line << "batch " << point << " " << batch << " " << tally.shots << " " << tally.failures << " "
+         << tally.y_errors << " " << tally.total_errors << " " << tally.seconds << "\n";
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.push_back(line.str());
+}
+
+void SweepLog::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for(auto& line: pending)
+        file << line;
+    pending.clear();
+    file.flush();
+}
+
+bool SweepLog::exists(std::string path) {
+    return std::filesystem::exists(path) && std::filesystem::file_size(path) > 0;
+}
+
+std::vector<LogContents> SweepLog::read_runs(std::string path) {
+    std::ifstream file(path);
+    if(!file.is_open())
+        throw BadConfig(std::string("Cannot open the checkpoint log: ") + path);
+    auto ret = std::vector<LogContents>();
+    std::string line;
+    while(std::getline(file, line)) {
+        if(file.eof() && !line.empty()) // no newline: torn by a crash
+            break;
+        std::istringstream stream(line);
+        std::string kind;
+        if(!(stream >> kind))
+            continue;
+        if(kind == "run") {
+            ret.push_back(LogContents());
+            if(!(stream >> ret.back().seed >> ret.back().batch_size))
+                throw BadConfig(path + ": bad run line");
+            continue;
+        }
+        if(ret.empty())
+            throw BadConfig(path + ": not a checkpoint log");
+        auto& run = ret.back();
+        if(kind == "point") {
+            int k;
+            auto point = SweepPoint();
+            if(!(stream >> k >> point.d >> point.p >> point.p_eff >> point.noise >> point.decoder >> point.rounds) || k != (int)run.points.size())
+                throw BadConfig(path + ": bad point line");
+            run.points.push_back(point);
+        } else if(kind == "batch") {
+            auto record = BatchRecord();
+            auto& tally = record.tally;
+            if(!(stream >> record.point >> record.batch >> tally.shots >> tally.failures >> tally.y_errors >> tally.total_errors >> tally.seconds))
+                throw BadConfig(path + ": bad batch line");
+            if(record.point < 0 || record.point >= (int)run.points.size())
+                throw BadConfig(path + ": batch of an unknown point");
+            run.batches.push_back(record);
+        } else {
+            throw BadConfig(path + ": unknown entry \"" + kind + "\"");
+        }
+    }
+    if(ret.empty())
+        throw BadConfig(path + ": not a checkpoint log");
+    return ret;
+}
+
+LogContents SweepLog::read(std::string path) {
+    auto runs = read_runs(path);
+    if(runs.size() > 1)
+        throw BadConfig(path + ": more than one run in a checkpoint log");
+    return runs[0];
+}
+
+void SweepLog::write_runs(std::string path, const std::vector<LogContents>& runs) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    if(!file.is_open())
+        throw BadConfig(std::string("Cannot write the log: ") + path);
+    file << std::setprecision(17);
+    for(auto& run: runs) {
+        file << "run " << run.seed << " " << run.batch_size << "\n";
+        for(int k = 0; k < (int)run.points.size(); k++) {
+            auto& point = run.points[k];
+            file << "point " << k << " " << point.d << " " << point.p << " " << point.p_eff << " "
+                 << point.noise << " " << point.decoder << " " << point.rounds << "\n";
+        }
+        file << std::setprecision(6);
+        for(auto& record: run.batches) {
+            auto& tally = record.tally;
+            file << "batch " << record.point << " " << record.batch << " " << tally.shots << " " << tally.failures << " "
+                 << tally.y_errors << " " << tally.total_errors << " " << tally.seconds << "\n";
+        }
+        file << std::setprecision(17);
+    }
+}
+
+static std::string point_key(const SweepPoint& point) {
+    std::ostringstream stream;
+    stream << std::setprecision(17) << point.d << " " << point.p << " " << point.p_eff << " "
+           << point.noise << " " << point.decoder << " " << point.rounds;
+    return stream.str();
+}
+
+std::vector<LogContents> merge_runs(const std::vector<std::string>& paths) {
+    auto ret = std::vector<LogContents>();
+    // per merged run: the index of every point key and the (point, batch) already counted
+    auto run_index = std::map<std::pair<unsigned long long, int>, int>();
+    auto point_index = std::vector<std::map<std::string, int>>();
+    auto seen = std::vector<std::set<std::pair<int, long long>>>();
+    for(auto& path: paths) {
+        for(auto& contents: SweepLog::read_runs(path)) {
+            auto id = std::make_pair(contents.seed, contents.batch_size);
+            if(run_index.find(id) == run_index.end()) {
+                run_index[id] = ret.size();
+                auto run = LogContents();
+                run.seed = contents.seed, run.batch_size = contents.batch_size;
+                ret.push_back(run);
+                point_index.push_back(std::map<std::string, int>());
+                seen.push_back(std::set<std::pair<int, long long>>());
+            }
+            int r = run_index[id];
+            auto local = std::vector<int>();
+            for(auto& point: contents.points) {
+                auto key = point_key(point);
+                if(point_index[r].find(key) == point_index[r].end()) {
+                    point_index[r][key] = ret[r].points.size();
+                    ret[r].points.push_back(point);
+                }
+                local.push_back(point_index[r][key]);
+            }
+            for(auto record: contents.batches) {
+                record.point = local[record.point];
+                if(seen[r].insert(std::make_pair(record.point, record.batch)).second)
+                    ret[r].batches.push_back(record);
+            }
+        }
+    }
+    // the same batches in the same order, whatever the order of the inputs
+    for(auto& run: ret) {
+        std::sort(run.batches.begin(), run.batches.end(), [](const BatchRecord& a, const BatchRecord& b) {
+            return std::make_pair(a.point, a.batch) < std::make_pair(b.point, b.batch);
+        });
+    }
+    return ret;
+}
+
+std::vector<std::pair<SweepPoint, Tally>> merge_logs(const std::vector<std::string>& paths) {
+    auto ret = std::vector<std::pair<SweepPoint, Tally>>();
+    auto index = std::map<std::string, int>();
+    for(auto& run: merge_runs(paths)) {
+        auto keys = std::vector<std::string>();
+        for(auto& point: run.points) {
+            auto key = point_key(point);
+            if(index.find(key) == index.end()) {
+                index[key] = ret.size();
+                ret.push_back(std::make_pair(point, Tally()));
+            }
+            keys.push_back(key);
+        }
+        for(auto& record: run.batches)
+            ret[index[keys[record.point]]].second += record.tally;
+    }
+    return ret;
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct BatchRecord {
+    int point;
+    long long batch;
+    Tally tally;
+};
+
+struct LogContents {
+    unsigned long long seed;
+    int batch_size;
+    std::vector<SweepPoint> points;
+    std::vector<BatchRecord> batches;
+};
+
+class SweepLog {
+    /*
+    An append-only record of a sweep, one line per entry:
+
+        run <seed> <batch_size>
+        point <k> <d> <p> <p_eff> <noise> <decoder> <rounds>
+        batch <k> <b> <shots> <failures> <y_errors> <total_errors> <seconds>
+
+    The random stream of a batch is fixed by (seed, k, b), so the batch lines
+    are all the state a sweep needs to resume. A torn last line, left by a
+    crash in the middle of a write, is ignored when reading.
+
+    A merged log holds one such section per run; it can be merged again but
+    not resumed.
+    */
+    std::ofstream file;
+    std::mutex mutex;
+    std::vector<std::string> pending;
+
+    public:
+    SweepLog() = delete;
+    // open for appending, the header is written if the file is new or empty
+    SweepLog(std::string path, const SweepConfig& config, const std::vector<SweepPoint>& points);
+
+    // buffered until the next flush
+    void add_batch(int point, long long batch, const Tally& tally);
+    void flush();
+
+    static bool exists(std::string path);
+    // the log of a single run
+    static LogContents read(std::string path);
+    static std::vector<LogContents> read_runs(std::string path);
+    static void write_runs(std::string path, const std::vector<LogContents>& runs);
+};
+
+// the union of the runs of several logs: a batch of the same seed, batch size, point and index is kept once
+std::vector<LogContents> merge_runs(const std::vector<std::string>& paths);
+
+// merge several logs: the batches of runs with the same seed are counted once, runs with different seeds add up
+std::vector<std::pair<SweepPoint, Tally>> merge_logs(const std::vector<std::string>& paths);
+
+}
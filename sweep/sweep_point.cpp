@@ -0,0 +1,258 @@
+#include "sweep_point.hpp"
+#include "exception.hpp"
+#include "statistics.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <tuple>
+
+namespace Err = ErrorDynamics;
+namespace Dc = Decoder;
+
+namespace Sweep {
+
+std::string SweepPoint::to_string() const {
+    std::ostringstream stream;
+    stream << "d = " << d << ", p = " << p << ", noise = " << noise << ", decoder = " << decoder << ", rounds = " << rounds;
+    return stream.str();
+}
+
+static std::shared_ptr<const Err::ErrorModel::RateMap> load_rate_map(std::string path) {
+    // read once, every batch of every thread builds its tables from the same map
+    static std::mutex mutex;
+    static std::map<std::string, std::shared_ptr<const Err::ErrorModel::RateMap>> maps;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& map = maps[path];
+    if(!map)
+        map = std::make_shared<const Err::ErrorModel::RateMap>(Err::ErrorModel::RateMap::load(path));
+    return map;
+}
+
+static std::shared_ptr<const Err::DetectorErrorModel> compile_circuit_noise(const SweepPoint& point) {
+    // compiled once, every batch of every thread samples the same model
+    static std::mutex mutex;
+    static std::map<std::tuple<int, int, double>, std::shared_ptr<const Err::DetectorErrorModel>> models;
+    if(point.rounds <= 1)
+        throw BadConfig(std::string("Circuit noise needs noisy syndrome rounds, rounds > 1"));
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& model = models[std::make_tuple(point.d, point.rounds, point.p_eff)];
+    if(!model)
+        model = std::make_shared<const Err::DetectorErrorModel>(Err::CodeScheme::PlanarShape(point.d, point.d), point.rounds, Err::CircuitNoise(point.p_eff));
+    return model;
+}
+
+std::shared_ptr<Err::ErrorModel::ErrorModelBase> make_error_model(const SweepPoint& point) {
+    double pm = (point.rounds > 1 ? point.p_eff * 2 / 3 : 0);
+    if(point.noise.rfind("rate_map:", 0) == 0) {
+        auto map = *load_rate_map(point.noise.substr(std::string("rate_map:").size()));
+        if(map.x != point.d || map.y != point.d)
+            throw BadConfig(point.noise + " is not of size " + std::to_string(point.d));
+        if(point.rounds == 1)
+            std::fill(map.pm.begin(), map.pm.end(), 0.0);
+        // scaled to a mean data qubit error rate of p_eff
+        double total = 0;
+        int sites = 0;
+        for(int n = 0; n < map.x * map.y; n++) {
+            if(((n / map.y) + (n % map.y)) % 2 == 0) {
+                total += map.px[n] + map.py[n] + map.pz[n];
+                sites++;
+            }
+        }
+        auto ret = std::make_shared<Err::ErrorModel::HeterogeneousError>(map);
+        if(total > 0)
+            ret->set_scale(point.p_eff * sites / total);
+        return ret;
+    }
+    if(point.noise == "iid_balanced")
+        return std::make_shared<Err::ErrorModel::IIDError>(point.p_eff / 3, point.p_eff / 3, point.p_eff / 3, pm);
+    if(point.noise == "iid_independent") {
+        double p_independent = sqrt(1 + point.p_eff) - 1;
+        return std::make_shared<Err::ErrorModel::IIDError>(p_independent, pow(p_independent, 2.0), p_independent, pm);
+    }
+    if(point.noise == "erasure")
+        return std::make_shared<Err::ErrorModel::ErasureError>(point.p_eff, 0, 0, 0, pm);
+    if(point.noise == "circuit")
+        throw BadConfig(std::string("Circuit noise has no error model of a round, only run_batch samples it"));
+    throw BadConfig(std::string("Unknown noise model: ") + point.noise);
+}
+
+std::shared_ptr<Dc::DecoderBase> make_decoder(const SweepPoint& point, Err::CodeScheme::PlanarShape shape, std::shared_ptr<Dc::Cache::DecodeCache> cache) {
+    bool measurement_error = point.rounds > 1;
+    double pm = (measurement_error ? point.p_eff * 2 / 3 : 0);
+    if(point.decoder == "mwpm" || point.decoder == "mwpm_cached") {
+        auto decoder = std::make_shared<Dc::Matching::StandardMWPMDecoder>(point.p_eff, point.p_eff, point.p_eff, pm, measurement_error, shape);
+        if(point.decoder == "mwpm_cached" && cache)
+            return std::make_shared<Dc::Cache::CachedDecoder>(decoder, cache);
+        return decoder;
+    }
+    if(point.decoder == "mwpm_weighted") {
+        // the weights of the rates the noise model draws from, uniform for iid noise
+        auto decoder = std::make_shared<Dc::Matching::WeightedMWPMDecoder>(point.p_eff, point.p_eff, point.p_eff, pm, measurement_error, shape);
+        if(point.noise == "circuit") {
+            auto circuit = compile_circuit_noise(point);
+            decoder->set_weight(circuit->x_flip_weight(), circuit->z_flip_weight());
+            decoder->set_measure_weight(circuit->measure_weight());
+            return decoder;
+        }
+        auto heterogeneous = std::dynamic_pointer_cast<Err::ErrorModel::HeterogeneousError>(make_error_model(point));
+        if(heterogeneous) {
+            decoder->set_weight(heterogeneous->x_flip_weight(shape), heterogeneous->z_flip_weight(shape));
+            if(measurement_error)
+                decoder->set_measure_weight(heterogeneous->measure_weight(shape));
+        }
+        return decoder;
+    }
+    if(point.decoder == "erasure")
+        return std::make_shared<Dc::Erasure::ErasureDecoder>(point.p_eff, point.p_eff, point.p_eff, pm, measurement_error, shape);
+    if(point.decoder.rfind("two_level:", 0) == 0)
+        return std::make_shared<Dc::Neural::TwoLevelDecoder>(point.decoder.substr(std::string("two_level:").size()), shape);
+    if(point.decoder == "hybrid" || point.decoder.rfind("hybrid:", 0) == 0) {
+        // a local predecoder, or the network of hybrid:<prefix>, in front of MWPM
+        std::shared_ptr<Dc::Hybrid::Predecoder> predecoder;
+        if(point.decoder == "hybrid")
+            predecoder = std::make_shared<Dc::Hybrid::LocalPredecoder>(shape, measurement_error);
+        else
+            predecoder = std::make_shared<Dc::Hybrid::ModelPredecoder>(
+                std::make_shared<Dc::Neural::TwoLevelDecoder>(point.decoder.substr(std::string("hybrid:").size()), shape), shape);
+        auto matcher = std::make_shared<Dc::Matching::StandardMWPMDecoder>(point.p_eff, point.p_eff, point.p_eff, pm, measurement_error, shape);
+        return std::make_shared<Dc::Hybrid::HybridDecoder>(predecoder, matcher);
+    }
+    throw BadConfig(std::string("Unknown decoder: ") + point.decoder);
+}
+
+std::shared_ptr<Err::CodeScheme::PlanarError> decode_shot(
+    Dc::DecoderBase& decoder,
+    Err::PlanarData data,
+    std::shared_ptr<Err::CodeScheme::PlanarErasure> erasure
+) {
+    // the erasure is passed along with the shot, so no decoder keeps the one of an earlier shot
+    auto erasure_decoder = dynamic_cast<Dc::Erasure::ErasureDecoder*>(&decoder);
+    if(erasure_decoder && erasure)
+        return (*erasure_decoder)(data, erasure);
+    return decoder(data);
+}
+
+void validate_point(const SweepPoint& point) {
+    if(point.noise == "circuit")
+        compile_circuit_noise(point);
+    else
+        make_error_model(point);
+    make_decoder(point, Err::CodeScheme::PlanarShape(point.d, point.d));
+}
+
+Tally run_batch(const SweepPoint& point, int batch_size, unsigned long long seed, std::shared_ptr<Dc::Cache::DecodeCache> cache) {
+    auto begin = std::chrono::steady_clock::now();
+    auto ret = Tally();
+    auto shape = Err::CodeScheme::PlanarShape(point.d, point.d);
+    // circuit noise is sampled from its detector error model, the other noises step a code
+    std::shared_ptr<const Err::DetectorErrorModel> circuit;
+    std::shared_ptr<Err::PlanarSurfaceCode> code;
+    std::mt19937 engine;
+    if(point.noise == "circuit") {
+        circuit = compile_circuit_noise(point);
+        std::seed_seq seq({(unsigned int)seed, (unsigned int)(seed >> 32)});
+        engine.seed(seq);
+    }
+    else {
+        auto error_model = make_error_model(point);
+        error_model->seed(seed);
+        code = std::make_shared<Err::PlanarSurfaceCode>(point.d, error_model);
+    }
+
+    auto decoder = make_decoder(point, shape, cache);
+
+    for(int _ = 0; _ < batch_size; _++) {
+        Err::PlanarData data;
+        // circuit noise erases nothing
+        std::shared_ptr<Err::CodeScheme::PlanarErasure> erasure;
+        if(circuit)
+            data = circuit->sample(engine);
+        else {
+            code->step(point.rounds);
+            data = code->get_data();
+            erasure = code->get_erasure();
+        }
+        auto correction = decode_shot(*decoder, data, erasure);
+        auto stat = data.second->count_errors();
+
+        auto corrected = data.second * correction;
+        ret.shots++;
+        if(!corrected->is_correct()) {
+            ret.failures++;
+            ret.y_errors += stat[2];
+            ret.total_errors += (stat[1] + stat[2] + stat[3]);
+        }
+        if(code)
+            code->reset();
+    }
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return ret;
+}
+
+void write_results(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<Tally>& tallies,
+    const std::vector<std::string>& status,
+    double confidence
+) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    file << "d,p,p_eff,noise,decoder,rounds,shots,failures,y_errors,total_errors,p_L,ci_low,ci_high,status,seconds" << std::endl;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        auto& tally = tallies[k];
+        auto interval = wilson_interval(tally.failures, tally.shots, confidence);
+        file << point.d << "," << point.p << "," << point.p_eff << "," << point.noise << "," << point.decoder << "," << point.rounds << ","
+             << tally.shots << "," << tally.failures << "," << tally.y_errors << "," << tally.total_errors << ","
+             << tally.rate() << "," << interval.first << "," << interval.second << "," << status[k] << "," << tally.seconds << std::endl;
+    }
+}
+
+void write_stats(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<Err::Util::Instrument::Stats>& stats
+) {
+    namespace In = Err::Util::Instrument;
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    std::ofstream file(path);
+    file << "d,p,noise,decoder,rounds";
+    for(int c = 0; c < In::num_counter; c++)
+        file << "," << In::name((In::Counter)c);
+    for(int t = 0; t < In::num_timer; t++)
+        file << "," << In::name((In::Timer)t) << "_seconds";
+    for(int h = 0; h < In::num_histogram; h++)
+        file << "," << In::name((In::Histogram)h) << "_log2_histogram";
+    file << std::endl;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& point = points[k];
+        file << point.d << "," << point.p << "," << point.noise << "," << point.decoder << "," << point.rounds;
+        for(int c = 0; c < In::num_counter; c++)
+            file << "," << stats[k].counter[c];
+        for(int t = 0; t < In::num_timer; t++)
+            file << "," << stats[k].nanoseconds[t] * 1e-9;
+        for(int h = 0; h < In::num_histogram; h++) {
+            // drop the empty buckets at the top
+            int last = In::num_bucket;
+            while(last > 1 && stats[k].histogram[h][last - 1] == 0)
+                last--;
+            file << ",";
+            for(int b = 0; b < last; b++)
+                file << (b ? ";" : "") << stats[k].histogram[h][b];
+        }
+        file << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "error_dynamics.hpp"
+#include "decoder.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct SweepPoint {
+    /*
+    One point of the grid.
+    noise:
+        iid_balanced    X, Y, Z with probability p_eff / 3 each
+        iid_independent independent X and Z flips, together of probability p_eff
+        erasure         every data qubit erased with probability p_eff
+        rate_map:<path> the per-qubit rates of RateMap::load(path), scaled to a mean data qubit error rate of p_eff
+        circuit         every fault of the syndrome extraction circuit at p_eff, sampled from its DetectorErrorModel;
+                        needs rounds > 1 and is only supported by run_batch
+    decoder:
+        mwpm            StandardMWPMDecoder
+        mwpm_cached     StandardMWPMDecoder behind a decode cache shared by the threads
+        mwpm_weighted   WeightedMWPMDecoder with the weights of the rates of a rate_map noise, or of the detector error model of a circuit noise
+        erasure         peeling, then erasure-weighted matching
+        two_level:<prefix>  TwoLevelDecoder with the exported weights <prefix>_lo.bin and <prefix>_hi.bin
+        hybrid          LocalPredecoder, then StandardMWPMDecoder on the residual defects
+        hybrid:<prefix>     the TwoLevelDecoder of two_level:<prefix> as predecoder, then StandardMWPMDecoder
+    rounds:
+        1 for perfect measurements, otherwise the number of noisy syndrome rounds
+    */
+    int d;
+    double p, p_eff;
+    std::string noise, decoder;
+    int rounds;
+
+    std::string to_string() const;
+};
+
+struct Tally {
+    // failures: logical errors, y_errors / total_errors: # Y-errors / # errors in the failed shots
+    long long shots, failures, y_errors, total_errors;
+    double seconds;
+
+    inline Tally() : shots(0), failures(0), y_errors(0), total_errors(0), seconds(0) {}
+    inline Tally& operator+=(const Tally& other) {
+        shots += other.shots, failures += other.failures;
+        y_errors += other.y_errors, total_errors += other.total_errors;
+        seconds += other.seconds;
+        return *this;
+    }
+    inline double rate() const { return shots == 0 ? 0.0 : (double)failures / (double)shots; }
+};
+
+// the stream of a batch is derive_seed(run seed, point, batch)
+using ErrorDynamics::Util::derive_seed;
+
+// the error model of a round, circuit noise has none and throws BadConfig
+std::shared_ptr<ErrorDynamics::ErrorModel::ErrorModelBase> make_error_model(const SweepPoint& point);
+
+// the decoder of a point, the cache is only used by mwpm_cached
+std::shared_ptr<Decoder::DecoderBase> make_decoder(const SweepPoint& point, ErrorDynamics::CodeScheme::PlanarShape shape, std::shared_ptr<Decoder::Cache::DecodeCache> cache = nullptr);
+
+// decode a shot, its erasure goes to a decoder that reads one; without one an erasure decoder sees none
+std::shared_ptr<ErrorDynamics::CodeScheme::PlanarError> decode_shot(
+    Decoder::DecoderBase& decoder,
+    ErrorDynamics::PlanarData data,
+    std::shared_ptr<ErrorDynamics::CodeScheme::PlanarErasure> erasure
+);
+
+// build the error model and the decoder of a point once, throws what run_batch would on a bad point
+void validate_point(const SweepPoint& point);
+
+// simulate and decode batch_size shots of a point, the cache is only used by mwpm_cached
+Tally run_batch(const SweepPoint& point, int batch_size, unsigned long long seed, std::shared_ptr<Decoder::Cache::DecodeCache> cache = nullptr);
+
+// one CSV row per point, with the Wilson interval of p_L
+void write_results(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<Tally>& tallies,
+    const std::vector<std::string>& status,
+    double confidence
+);
+
+// one CSV row per point of the instrumentation statistics, the histograms as ";"-separated buckets
+void write_stats(
+    std::string path,
+    const std::vector<SweepPoint>& points,
+    const std::vector<ErrorDynamics::Util::Instrument::Stats>& stats
+);
+
+}
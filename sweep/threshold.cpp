@@ -0,0 +1,271 @@
+#include "threshold.hpp"
+#include "exception.hpp"
+#include "sweep_engine.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <random>
+
+namespace Sweep {
+
+namespace {
+
+struct FitRow {
+    double distance, p, rate, weight;
+};
+
+// weighted least squares of a + b x + c x^2 at fixed (p_th, nu), returns chi^2
+double solve_quadratic(const std::vector<FitRow>& rows, double p_th, double nu, std::array<double, 3>& coefficient) {
+    double m[3][4] = {{0}};
+    for(auto& row: rows) {
+        double x = (row.p - p_th) * std::pow(row.distance, 1.0 / nu);
+        double phi[3] = {1, x, x * x};
+        for(int r = 0; r < 3; r++) {
+            for(int c = 0; c < 3; c++)
+                m[r][c] += row.weight * phi[r] * phi[c];
+            m[r][3] += row.weight * phi[r] * row.rate;
+        }
+    }
+    // Gaussian elimination with partial pivoting
+    for(int c = 0; c < 3; c++) {
+        int pivot = c;
+        for(int r = c + 1; r < 3; r++) {
+            if(std::fabs(m[r][c]) > std::fabs(m[pivot][c]))
+                pivot = r;
+        }
+        if(std::fabs(m[pivot][c]) < 1e-300)
+            return std::numeric_limits<double>::infinity();
+        for(int k = 0; k < 4; k++)
+            std::swap(m[c][k], m[pivot][k]);
+        for(int r = 0; r < 3; r++) {
+            if(r == c)
+                continue;
+            double factor = m[r][c] / m[c][c];
+            for(int k = c; k < 4; k++)
+                m[r][k] -= factor * m[c][k];
+        }
+    }
+    for(int r = 0; r < 3; r++)
+        coefficient[r] = m[r][3] / m[r][r];
+
+    double chi2 = 0;
+    for(auto& row: rows) {
+        double x = (row.p - p_th) * std::pow(row.distance, 1.0 / nu);
+        double residual = row.rate - (coefficient[0] + coefficient[1] * x + coefficient[2] * x * x);
+        chi2 += row.weight * residual * residual;
+    }
+    return chi2;
+}
+
+// Nelder-Mead over (p_th, log nu), p_th stays within the sampled p
+std::array<double, 2> minimize(const std::vector<FitRow>& rows, double p_min, double p_max, std::array<double, 2> start, std::array<double, 2> step) {
+    auto coefficient = std::array<double, 3>();
+    auto objective = [&](const std::array<double, 2>& v) {
+        if(v[0] < p_min || v[0] > p_max || std::fabs(v[1]) > 3)
+            return std::numeric_limits<double>::infinity();
+        return solve_quadratic(rows, v[0], std::exp(v[1]), coefficient);
+    };
+    std::array<std::array<double, 2>, 3> simplex = {start, start, start};
+    simplex[1][0] += step[0], simplex[2][1] += step[1];
+    std::array<double, 3> value;
+    for(int n = 0; n < 3; n++)
+        value[n] = objective(simplex[n]);
+
+    for(int _ = 0; _ < 400; _++) {
+        std::array<int, 3> order = {0, 1, 2};
+        std::sort(order.begin(), order.end(), [&value](int a, int b) { return value[a] < value[b]; });
+        int best = order[0], middle = order[1], worst = order[2];
+        std::array<double, 2> centroid;
+        for(int k = 0; k < 2; k++)
+            centroid[k] = (simplex[best][k] + simplex[middle][k]) / 2;
+        auto along = [&](double t) {
+            std::array<double, 2> ret;
+            for(int k = 0; k < 2; k++)
+                ret[k] = centroid[k] + t * (simplex[worst][k] - centroid[k]);
+            return ret;
+        };
+        auto reflected = along(-1);
+        double reflected_value = objective(reflected);
+        if(reflected_value < value[best]) {
+            auto expanded = along(-2);
+            double expanded_value = objective(expanded);
+            if(expanded_value < reflected_value)
+                simplex[worst] = expanded, value[worst] = expanded_value;
+            else
+                simplex[worst] = reflected, value[worst] = reflected_value;
+        } else if(reflected_value < value[middle]) {
+            simplex[worst] = reflected, value[worst] = reflected_value;
+        } else {
+            auto contracted = along(0.5);
+            double contracted_value = objective(contracted);
+            if(contracted_value < value[worst]) {
+                simplex[worst] = contracted, value[worst] = contracted_value;
+            } else {
+                for(int n: {middle, worst}) {
+                    for(int k = 0; k < 2; k++)
+                        simplex[n][k] = (simplex[n][k] + simplex[best][k]) / 2;
+                    value[n] = objective(simplex[n]);
+                }
+            }
+        }
+    }
+    int best = (int)(std::min_element(value.begin(), value.end()) - value.begin());
+    return simplex[best];
+}
+
+}
+
+ThresholdFit fit_threshold(
+    const std::vector<SweepPoint>& points,
+    const std::vector<Tally>& tallies,
+    double p_low,
+    double p_high,
+    const ThresholdFit* start
+) {
+    auto rows = std::vector<FitRow>();
+    double p_min = std::numeric_limits<double>::infinity(), p_max = 0;
+    for(int k = 0; k < (int)points.size(); k++) {
+        auto& tally = tallies[k];
+        if(tally.shots == 0 || points[k].p < p_low || points[k].p > p_high)
+            continue;
+        // the variance of the Beta posterior stays finite at 0 failures
+        double n = (double)tally.shots, f = (double)tally.failures;
+        double variance = (f + 1) * (n - f + 1) / ((n + 2) * (n + 2) * (n + 3));
+        rows.push_back(FitRow({(points[k].d + 1) / 2.0, points[k].p, tally.rate(), 1 / variance}));
+        p_min = std::min(p_min, points[k].p), p_max = std::max(p_max, points[k].p);
+    }
+    if(rows.size() < 5)
+        throw BadConfig(std::string("Too few points to fit the threshold"));
+
+    auto coefficient = std::array<double, 3>();
+    auto best = std::array<double, 2>();
+    if(start) {
+        best = {std::min(p_max, std::max(p_min, start->p_th)), std::log(start->nu)};
+    } else {
+        // a coarse grid first, the chi^2 surface has several local minima
+        double best_value = std::numeric_limits<double>::infinity();
+        for(int i = 0; i <= 40; i++) {
+            for(double nu = 0.5; nu <= 3.0; nu += 0.25) {
+                double p_th = p_min + (p_max - p_min) * i / 40;
+                double value = solve_quadratic(rows, p_th, nu, coefficient);
+                if(value < best_value)
+                    best_value = value, best = {p_th, std::log(nu)};
+            }
+        }
+    }
+    best = minimize(rows, p_min, p_max, best, {std::max((p_max - p_min) / 20, best[0] * 0.01), 0.1});
+
+    auto ret = ThresholdFit();
+    ret.p_th = best[0], ret.nu = std::exp(best[1]);
+    ret.chi2 = solve_quadratic(rows, ret.p_th, ret.nu, coefficient);
+    ret.a = coefficient[0], ret.b = coefficient[1], ret.c = coefficient[2];
+    ret.num_points = (int)rows.size();
+    return ret;
+}
+
+ThresholdSearch::ThresholdSearch(const SweepConfig& _config) : config(_config) {
+    if(config.noise_list.size() != 1 || config.decoder_list.size() != 1 || config.rounds_list.size() != 1)
+        throw BadConfig(std::string("A threshold search takes one noise, decoder and rounds"));
+    if(config.d_list.size() < 2)
+        throw BadConfig(std::string("A threshold search needs at least two distances"));
+    // every round is a fresh grid, it cannot resume from a log
+    config.checkpoint = "";
+    iterations = 0;
+}
+
+void ThresholdSearch::sample(const std::vector<double>& p_list, int round) {
+    auto round_config = config;
+    round_config.p_list = p_list;
+    if(round > 0)
+        round_config.seed = derive_seed(config.seed, ~0ull, round);
+    auto engine = SweepEngine(round_config);
+    engine.run();
+    for(int k = 0; k < (int)engine.get_points().size(); k++) {
+        points.push_back(engine.get_points()[k]);
+        tallies.push_back(engine.get_tallies()[k]);
+        round_of.push_back(round);
+    }
+}
+
+void ThresholdSearch::refit() {
+    const double infinity = std::numeric_limits<double>::infinity();
+    double p_low = -infinity, p_high = infinity;
+    fit = fit_threshold(points, tallies, p_low, p_high, iterations > 0 ? &fit : nullptr);
+    // the expansion only holds near p_th, narrow down once enough points are there
+    int inside = 0;
+    for(auto& point: points) {
+        if(std::fabs(point.p - fit.p_th) <= config.threshold_window * fit.p_th)
+            inside++;
+    }
+    if(inside >= 3 * (int)config.d_list.size()) {
+        p_low = fit.p_th * (1 - config.threshold_window), p_high = fit.p_th * (1 + config.threshold_window);
+        fit = fit_threshold(points, tallies, p_low, p_high, &fit);
+    }
+
+    std::mt19937_64 rng_engine(derive_seed(config.seed, ~0ull - 1, iterations));
+    auto samples = std::vector<double>();
+    for(int _ = 0; _ < config.bootstrap; _++) {
+        auto resampled = tallies;
+        for(auto& tally: resampled) {
+            std::binomial_distribution<long long> failures(tally.shots, tally.rate());
+            tally.failures = failures(rng_engine);
+        }
+        samples.push_back(fit_threshold(points, resampled, p_low, p_high, &fit).p_th);
+    }
+    if(samples.empty()) {
+        fit.ci_low = fit.ci_high = fit.p_th;
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto quantile = [&samples](double q) {
+        return samples[std::min((int)samples.size() - 1, std::max(0, (int)(q * samples.size())))];
+    };
+    fit.ci_low = quantile((1 - config.confidence) / 2);
+    fit.ci_high = quantile((1 + config.confidence) / 2);
+}
+
+void ThresholdSearch::run() {
+    sample(config.p_list, 0);
+    refit();
+    while(iterations < config.threshold_iterations) {
+        double width = fit.ci_high - fit.ci_low;
+        if(config.threshold_ci_width > 0 && width <= config.threshold_ci_width)
+            break;
+        iterations++;
+        // the next points cover the interval and half its width on each side, within the coarse grid
+        auto range = std::minmax_element(config.p_list.begin(), config.p_list.end());
+        double low = std::max(*range.first, fit.ci_low - width / 2);
+        double high = std::min(*range.second, fit.ci_high + width / 2);
+        auto p_list = std::vector<double>();
+        for(int n = 0; n < config.threshold_points; n++)
+            p_list.push_back(config.threshold_points == 1 ? fit.p_th : low + (high - low) * n / (config.threshold_points - 1));
+        sample(p_list, iterations);
+        refit();
+    }
+}
+
+void ThresholdSearch::write_results(std::string path) const {
+    auto status = std::vector<std::string>();
+    for(auto round: round_of)
+        status.push_back(round == 0 ? "coarse" : "round_" + std::to_string(round));
+    Sweep::write_results(path, points, tallies, status, config.confidence);
+}
+
+void ThresholdSearch::write_threshold(std::string path) const {
+    auto parent = std::filesystem::path(path).parent_path();
+    if(!parent.empty())
+        std::filesystem::create_directories(parent);
+    long long shots = 0;
+    for(auto& tally: tallies)
+        shots += tally.shots;
+    std::ofstream file(path);
+    file << "noise,decoder,rounds,p_th,ci_low,ci_high,nu,a,b,c,chi2,num_points,iterations,shots" << std::endl;
+    file << config.noise_list[0] << "," << config.decoder_list[0] << "," << config.rounds_list[0] << ","
+         << fit.p_th << "," << fit.ci_low << "," << fit.ci_high << "," << fit.nu << "," << fit.a << "," << fit.b << "," << fit.c << ","
+         << fit.chi2 << "," << fit.num_points << "," << iterations << "," << shots << std::endl;
+}
+
+}
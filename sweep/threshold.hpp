@@ -0,0 +1,73 @@
+#pragma once
+
+#include "sweep_config.hpp"
+#include "sweep_point.hpp"
+#include <string>
+#include <vector>
+
+namespace Sweep {
+
+struct ThresholdFit {
+    /*
+    Finite-size scaling near the threshold:
+
+        p_L = a + b x + c x^2,  x = (p - p_th) L^(1 / nu)
+
+    with L = (d + 1) / 2 the code distance, fitted by weighted least squares.
+    [ci_low, ci_high] is a parametric bootstrap interval of p_th.
+    */
+    double p_th, nu, a, b, c;
+    double chi2;
+    int num_points;
+    double ci_low, ci_high;
+
+    inline ThresholdFit() : p_th(0), nu(1), a(0), b(0), c(0), chi2(0), num_points(0), ci_low(0), ci_high(1) {}
+};
+
+// the best fit over the points with p in [p_low, p_high], start is the initial guess if given
+ThresholdFit fit_threshold(
+    const std::vector<SweepPoint>& points,
+    const std::vector<Tally>& tallies,
+    double p_low,
+    double p_high,
+    const ThresholdFit* start = nullptr
+);
+
+class ThresholdSearch {
+    /*
+    Locate the threshold of one (noise, decoder, rounds) of a SweepConfig:
+    sweep the coarse grid d_list x p_list, fit, and then spend the shots of
+    every further round on threshold_points values of p spread over the
+    interval of p_th, until the interval is narrower than threshold_ci_width
+    or threshold_iterations rounds are done. Every round is a SweepEngine run
+    with its own seed, the tallies of all rounds are kept.
+    */
+    SweepConfig config;
+    std::vector<SweepPoint> points;
+    std::vector<Tally> tallies;
+    // the round which sampled each point, 0 for the coarse grid
+    std::vector<int> round_of;
+    ThresholdFit fit;
+    int iterations;
+
+    void sample(const std::vector<double>& p_list, int round);
+    void refit();
+
+    public:
+    ThresholdSearch() = delete;
+    ThresholdSearch(const SweepConfig& _config);
+
+    void run();
+
+    inline const ThresholdFit& get_fit() const { return fit; }
+    inline int get_iterations() const { return iterations; }
+    inline const std::vector<SweepPoint>& get_points() const { return points; }
+    inline const std::vector<Tally>& get_tallies() const { return tallies; }
+
+    // the raw tallies of every round, one CSV row per point
+    void write_results(std::string path) const;
+    // one CSV row with the fit
+    void write_threshold(std::string path) const;
+};
+
+}